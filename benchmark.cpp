@@ -0,0 +1,34 @@
+#include "src/Benchmark.h"
+
+#include <cstdio>
+#include <string>
+
+int main(int argc, char* argv[])
+{
+    // [--output report.json] [--scenario name] [--frames N] [--warmup N] [--size WxH] [--fallback-adapter]
+    grass::Benchmark::Settings settings;
+    std::string reportPath = "benchmark_report.json";
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--output" && i + 1 < argc)
+            reportPath = argv[++i];
+        else if (arg == "--scenario" && i + 1 < argc)
+            settings.scenarioFilter = argv[++i];
+        else if (arg == "--frames" && i + 1 < argc)
+            settings.frames = std::stoul(argv[++i]);
+        else if (arg == "--warmup" && i + 1 < argc)
+            settings.warmupFrames = std::stoul(argv[++i]);
+        else if (arg == "--size" && i + 1 < argc)
+            std::sscanf(argv[++i], "%ux%u", &settings.size.x, &settings.size.y);
+        else if (arg == "--fallback-adapter")
+            settings.forceFallbackAdapter = true;
+    }
+
+    grass::Benchmark benchmark(settings);
+    const bool success = benchmark.run(grass::Benchmark::getDefaultScenarios());
+    benchmark.printSummary();
+    if (!benchmark.writeReport(reportPath)) return 1;
+
+    return success ? 0 : 1;
+}
@@ -1,9 +1,29 @@
 #include "src/Engine.h"
 
-int main()
+#include <cstdio>
+#include <string>
+
+int main(int argc, char* argv[])
 {
+    // --headless [--frames N] [--size WxH] [--fallback-adapter], --no-vsync
+    auto config = std::make_shared<grass::GlobalConfig>();
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--headless")
+            config->headless = true;
+        else if (arg == "--frames" && i + 1 < argc)
+            config->headlessFrameCount = std::stoul(argv[++i]);
+        else if (arg == "--size" && i + 1 < argc)
+            std::sscanf(argv[++i], "%ux%u", &config->headlessSize.x, &config->headlessSize.y);
+        else if (arg == "--fallback-adapter")
+            config->forceFallbackAdapter = true;
+        else if (arg == "--no-vsync")
+            config->vsync = false;
+    }
+
     grass::Engine engine;
-    if (!engine.init()) return 1;
+    if (!engine.init(config)) return 1;
 
     engine.run();
 
@@ -1,3 +1,5 @@
+#include "common.wgsl"
+
 @group(0) @binding(0) var<uniform> global: Global;
 @group(0) @binding(1) var texSampler: sampler;
 @group(1) @binding(0) var<uniform> settings: BladeSettings;
@@ -1,5 +1,9 @@
+#include "common.wgsl"
+
 @group(0) @binding(0) var<uniform> global: Global;
-@group(1) @binding(1) var<storage, read> bladePositions: array<Blade>;
+@group(1) @binding(1) var<storage, read> staticBlades: array<StoredBladeStatic>;
+@group(1) @binding(4) var<storage, read> visibleBlades: array<u32>;
+@group(1) @binding(5) var<storage, read> dynamicBlades: array<StoredBladeDynamic>;
 
 
 fn bezier(t: f32, c0: vec3f, c1: vec3f, c2: vec3f) -> vec3f {
@@ -26,30 +30,33 @@ fn vertex_main(
     @location(1) normal: vec3f,
     @location(2) texCoord: vec2f
 ) -> BladeVertexOut {
-    let blade = bladePositions[instanceIndex];
+    let bladeIndex = visibleBlades[instanceIndex];
+    let blade = unpackBladeStatic(staticBlades[bladeIndex]);
+    let bladeState = unpackBladeDynamic(dynamicBlades[bladeIndex], blade.c0, blade.up);
 
-    var c1 = blade.c1;
-    let swayAmplitude = SWAY_Y * distance(blade.c0.xz, blade.c1.xz) / blade.height;
+    var c1 = bladeState.c1;
+    let swayAmplitude = SWAY_Y * distance(blade.c0.xz, bladeState.c1.xz) / blade.height;
     let swayPhase = blade.idHash * pos.y;
     // Bobbing up and down gives a better swaying effect than just tilting uniformally
     c1 += pos.y * swayAmplitude * sin(SWAY_FREQ * (global.time + swayPhase));
 
     // Conservation of length
     let L0 = distance(blade.c0, c1);
-    let L1 = distance(blade.c0, blade.c2) + distance(blade.c2, c1);
+    let L1 = distance(blade.c0, bladeState.c2) + distance(bladeState.c2, c1);
     let L = (2.0 * L0 + L1) / 3.0;
     let r = blade.height / L;
 
-    var c2 = blade.c0 + r * (blade.c2 - blade.c0);
+    var c2 = blade.c0 + r * (bladeState.c2 - blade.c0);
     c1 = c2 + r * (c1 - c2);
 
-    var bezierPos = bezier(pos.y, blade.c0, c1, blade.c2);
+    var bezierPos = bezier(pos.y, blade.c0, c1, bladeState.c2);
     // "Extruding along tangent"
-    var tangent = normalize(cross(-blade.facingDirection, vec3f(0.0, 1.0, 0.0)));
+    let facingDirection = vec3f(blade.facingDirection.x, 0.0, blade.facingDirection.y);
+    var tangent = normalize(cross(-facingDirection, blade.up));
     bezierPos += pos.z * tangent;
     var worldPos = vec4f(bezierPos, 1.0);
 
-    var bitangent = normalize(dBezier(pos.y, blade.c0, c1, blade.c2));
+    var bitangent = normalize(dBezier(pos.y, blade.c0, c1, bladeState.c2));
     var modifiedNormal = normalize(cross(bitangent, tangent));
 
     // Front and back faces have different vectors
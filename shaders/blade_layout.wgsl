@@ -0,0 +1,19 @@
+// Full precision blade storage : 48 + 32 bytes per blade
+alias StoredBladeStatic = BladeStatic;
+alias StoredBladeDynamic = BladeDynamic;
+
+fn packBladeStatic(blade: BladeStatic) -> StoredBladeStatic {
+    return blade;
+}
+
+fn unpackBladeStatic(stored: StoredBladeStatic) -> BladeStatic {
+    return stored;
+}
+
+fn packBladeDynamic(bladeState: BladeDynamic, c0: vec3f, up: vec3f) -> StoredBladeDynamic {
+    return bladeState;
+}
+
+fn unpackBladeDynamic(stored: StoredBladeDynamic, c0: vec3f, up: vec3f) -> BladeDynamic {
+    return stored;
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+// Quantized blade storage : 20 + 12 bytes per blade
+const TWO_PI = 6.28318530718;
+
+struct StoredBladeStatic {
+    c0x: f32,
+    c0y: f32,
+    c0z: f32,
+    heightFacingRelative: u32, // height f16 | facing angle unorm8 | relativeHeight unorm8
+    idHashUp: u32, // idHash unorm16 | up.xz snorm8x2
+}
+
+struct StoredBladeDynamic {
+    c1xy: u32, // f16x2 offset from c0
+    c1zC2: u32, // f16 offset from c0 | f16 c2 height along up
+    collisionStrength: u32, // unorm16
+}
+
+fn packBladeStatic(blade: BladeStatic) -> StoredBladeStatic {
+    let facingAngle = fract(atan2(blade.facingDirection.y, blade.facingDirection.x) / TWO_PI);
+    let facingAndRelative = pack4x8unorm(vec4f(0.0, 0.0, facingAngle, blade.relativeHeight));
+
+    var stored: StoredBladeStatic;
+    stored.c0x = blade.c0.x;
+    stored.c0y = blade.c0.y;
+    stored.c0z = blade.c0.z;
+    stored.heightFacingRelative = (pack2x16float(vec2f(blade.height, 0.0)) & 0xffffu) | (facingAndRelative & 0xffff0000u);
+    // Terrain normals always point upwards, y is rebuilt from xz
+    stored.idHashUp = (pack2x16unorm(vec2f(blade.idHash, 0.0)) & 0xffffu) | (pack4x8snorm(vec4f(0.0, 0.0, blade.up.xz)) & 0xffff0000u);
+    return stored;
+}
+
+fn unpackBladeStatic(stored: StoredBladeStatic) -> BladeStatic {
+    let facingAndRelative = unpack4x8unorm(stored.heightFacingRelative);
+    let facingAngle = facingAndRelative.z * TWO_PI;
+
+    var blade: BladeStatic;
+    blade.c0 = vec3f(stored.c0x, stored.c0y, stored.c0z);
+    blade.height = unpack2x16float(stored.heightFacingRelative).x;
+    blade.facingDirection = vec2f(cos(facingAngle), sin(facingAngle));
+    blade.relativeHeight = facingAndRelative.w;
+    blade.idHash = unpack2x16unorm(stored.idHashUp).x;
+    let upXZ = unpack4x8snorm(stored.idHashUp).zw;
+    blade.up = vec3f(upXZ.x, sqrt(max(1.0 - dot(upXZ, upXZ), 0.0)), upXZ.y);
+    return blade;
+}
+
+// c2 always sits above c0 along up (see calcC2 in move.compute.wgsl), a single f16 is enough
+fn packBladeDynamic(bladeState: BladeDynamic, c0: vec3f, up: vec3f) -> StoredBladeDynamic {
+    let c1Offset = bladeState.c1 - c0;
+
+    var stored: StoredBladeDynamic;
+    stored.c1xy = pack2x16float(c1Offset.xy);
+    stored.c1zC2 = pack2x16float(vec2f(c1Offset.z, dot(bladeState.c2 - c0, up)));
+    stored.collisionStrength = pack2x16unorm(vec2f(bladeState.collisionStrength, 0.0));
+    return stored;
+}
+
+fn unpackBladeDynamic(stored: StoredBladeDynamic, c0: vec3f, up: vec3f) -> BladeDynamic {
+    let c1zC2 = unpack2x16float(stored.c1zC2);
+
+    var bladeState: BladeDynamic;
+    bladeState.c1 = c0 + vec3f(unpack2x16float(stored.c1xy), c1zC2.x);
+    bladeState.c2 = c0 + c1zC2.y * up;
+    bladeState.collisionStrength = unpack2x16unorm(stored.collisionStrength).x;
+    return bladeState;
+}
\ No newline at end of file
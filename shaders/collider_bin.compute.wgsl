@@ -0,0 +1,37 @@
+#include "colliders.wgsl"
+
+// One invocation per collider, adding it to the list of every cell it can reach
+
+@group(0) @binding(0) var<uniform> grid: ColliderGrid;
+@group(0) @binding(1) var<storage, read> colliders: array<Collider>;
+@group(0) @binding(2) var<storage, read_write> cellCounts: array<atomic<u32>>; // cleared before the pass
+@group(0) @binding(3) var<storage, read_write> cellColliders: array<u32>; // maxCellColliders per cell
+
+@compute
+@workgroup_size(64, 1, 1)
+fn main(@builtin(global_invocation_id) global_id: vec3<u32>) {
+    if global_id.x >= grid.colliderCount {
+        return;
+    }
+
+    let collider = colliders[global_id.x];
+    let extent = collider.radius + grid.reach;
+    let firstCell = getColliderCell(grid, min(collider.a.xz, collider.b.xz) - extent);
+    let lastCell = getColliderCell(grid, max(collider.a.xz, collider.b.xz) + extent);
+    let gridEnd = vec2i(i32(grid.cellsPerSide) - 1);
+    if any(lastCell < vec2i(0)) || any(firstCell > gridEnd) {
+        return;
+    }
+
+    let first = max(firstCell, vec2i(0));
+    let last = min(lastCell, gridEnd);
+    for (var y = first.y; y <= last.y; y = y + 1) {
+        for (var x = first.x; x <= last.x; x = x + 1) {
+            let cell = getColliderCellIndex(grid, vec2i(x, y));
+            let slot = atomicAdd(&cellCounts[cell], 1u);
+            if slot < grid.maxCellColliders {
+                cellColliders[cell * grid.maxCellColliders + slot] = global_id.x;
+            }
+        }
+    }
+}
\ No newline at end of file
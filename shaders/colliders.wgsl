@@ -0,0 +1,38 @@
+// Colliders pushing the blades, binned into a uniform grid centered on the camera. See ComputeManager::updateColliders
+
+// Sphere when a and b are equal, capsule around the segment otherwise
+struct Collider {
+    a: vec3f,
+    radius: f32,
+    b: vec3f,
+};
+
+struct ColliderGrid {
+    origin: vec2f, // world xz of the grid corner
+    cellSize: f32,
+    reach: f32, // distance past its radius at which a collider touches blades, the tallest blade height
+    colliderCount: u32,
+    cellsPerSide: u32,
+    maxCellColliders: u32, // the colliders binned past that in a cell are ignored
+};
+
+
+// Negative or past cellsPerSide outside of the grid
+fn getColliderCell(grid: ColliderGrid, xz: vec2f) -> vec2i {
+    return vec2i(floor((xz - grid.origin) / grid.cellSize));
+}
+
+fn isColliderCellInGrid(grid: ColliderGrid, cell: vec2i) -> bool {
+    return all(cell >= vec2i(0)) && all(cell < vec2i(i32(grid.cellsPerSide)));
+}
+
+fn getColliderCellIndex(grid: ColliderGrid, cell: vec2i) -> u32 {
+    return u32(cell.y) * grid.cellsPerSide + u32(cell.x);
+}
+
+// Center of the sphere touching p, on the capsule segment
+fn getClosestColliderCenter(collider: Collider, p: vec3f) -> vec3f {
+    let segment = collider.b - collider.a;
+    let t = clamp(dot(p - collider.a, segment) / max(dot(segment, segment), 1e-8), 0.0, 1.0);
+    return collider.a + t * segment;
+}
\ No newline at end of file
@@ -1,4 +1,4 @@
-// TODO change constant up vector with terrain normal
+// World up, blades grow along their own terrain normal (BladeStatic.up)
 const UP = vec3f(0.0, 1.0, 0.0);
 const FOG_EXT = 2.0;
 const FOG_DENSITY = 0.09;
@@ -7,16 +7,50 @@ fn exponentialFog(distance: f32) -> f32 {
     return pow(2.0, -pow(FOG_DENSITY * distance, FOG_EXT));
 }
 
-struct Blade {
+// Blade compute dispatch, overridden by ComputeManager at pipeline creation
+override WORKGROUP_SIZE_X: u32 = 64;
+override WORKGROUP_SIZE_Y: u32 = 1;
+override TILED_DISPATCH: bool = false;
+
+// One per chunk, see ChunkUniformData
+struct Chunk {
+    cellOffset: vec2i, // first blade cell of the chunk in the world grid
+    cellCount: vec2u, // blade cells covered by the chunk, smaller on the field border
+    firstBlade: u32, // start of the chunk range in the blade buffers
+    bladesPerSide: u32, // dispatch grid side, same for every chunk
+}
+
+// Returns the chunk cell (xy) and flat index in the chunk range (z) handled by an invocation.
+// Out of bounds invocations get a cell outside of cellCount.
+fn getBladeCell(globalId: vec3u, workgroupId: vec3u, localIndex: u32, numWorkgroups: vec3u, bladesPerSide: u32) -> vec3u {
+    if TILED_DISPATCH {
+        return vec3u(globalId.xy, globalId.y * bladesPerSide + globalId.x);
+    }
+    // Linear workgroups may be folded into a 2D grid to stay under maxComputeWorkgroupsPerDimension
+    let workgroupIndex = workgroupId.x + workgroupId.y * numWorkgroups.x;
+    let index = workgroupIndex * WORKGROUP_SIZE_X * WORKGROUP_SIZE_Y + localIndex;
+    return vec3u(index % bladesPerSide, index / bladesPerSide, index);
+}
+
+fn isCellInBounds(cell: vec3u, cellCount: vec2u) -> bool {
+    return cell.x < cellCount.x && cell.y < cellCount.y;
+}
+
+// Written once by generation
+struct BladeStatic {
     c0: vec3f, // root
     idHash: f32,
-    uv: vec2f,
+    facingDirection: vec2f, // xz
     height: f32,
     relativeHeight: f32,
+    up: vec3f, // terrain normal
+}
+
+// Written every frame by movement
+struct BladeDynamic {
     c1: vec3f, // tip
-    c2: vec3f, // bendingControlPoint
-    facingDirection: vec3f,
     collisionStrength: f32,
+    c2: vec3f, // bendingControlPoint
 }
 
 struct Camera {
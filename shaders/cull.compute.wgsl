@@ -0,0 +1,83 @@
+#include "common.wgsl"
+
+struct CullSettings {
+    frustumPlanes: array<vec4f, 6>, // xyz normal pointing inside + w distance
+    cameraPosition: vec3f,
+    maxDistance: f32,
+    frustumCulling: u32,
+    lodStride: u32,
+    lodCount: u32,
+    lodDistances: vec4f,
+};
+
+struct DrawIndexedIndirectArgs {
+    indexCount: u32,
+    instanceCount: atomic<u32>,
+    firstIndex: u32,
+    baseVertex: i32,
+    firstInstance: u32,
+};
+
+@group(0) @binding(0) var<storage, read> staticBlades: array<StoredBladeStatic>;
+@group(0) @binding(1) var<storage, read> dynamicBlades: array<StoredBladeDynamic>;
+@group(1) @binding(0) var<uniform> cullSettings: CullSettings;
+@group(1) @binding(1) var<storage, read_write> visibleBlades: array<u32>; // one list per LOD
+@group(1) @binding(2) var<storage, read_write> drawArgs: array<DrawIndexedIndirectArgs>; // one draw per LOD
+@group(2) @binding(0) var<uniform> chunk: Chunk;
+
+// Covers the blade width and the sway added in the vertex shader
+const BOUNDS_MARGIN = 0.1;
+
+
+fn isSphereInFrustum(center: vec3f, radius: f32) -> bool {
+    for (var i: u32 = 0u; i < 6u; i = i + 1u) {
+        let plane = cullSettings.frustumPlanes[i];
+        if dot(plane.xyz, center) + plane.w < -radius {
+            return false;
+        }
+    }
+    return true;
+}
+
+@compute
+@workgroup_size(WORKGROUP_SIZE_X, WORKGROUP_SIZE_Y, 1)
+fn main(
+    @builtin(global_invocation_id) global_id: vec3<u32>,
+    @builtin(workgroup_id) workgroup_id: vec3<u32>,
+    @builtin(local_invocation_index) local_invocation_index: u32,
+    @builtin(num_workgroups) num_workgroups: vec3<u32>
+) {
+    let cell = getBladeCell(global_id, workgroup_id, local_invocation_index, num_workgroups, chunk.bladesPerSide);
+    if !isCellInBounds(cell, chunk.cellCount) {
+        return;
+    }
+    let bladeIndex = chunk.firstBlade + cell.z;
+    let blade = unpackBladeStatic(staticBlades[bladeIndex]);
+    let c0 = blade.c0;
+    let bladeState = unpackBladeDynamic(dynamicBlades[bladeIndex], c0, blade.up);
+
+    // A quadratic Bézier curve lies inside the convex hull of its control points
+    let boundsMin = min(min(c0, bladeState.c1), bladeState.c2);
+    let boundsMax = max(max(c0, bladeState.c1), bladeState.c2);
+    let center = 0.5 * (boundsMin + boundsMax);
+    let radius = 0.5 * distance(boundsMin, boundsMax) + BOUNDS_MARGIN;
+
+    let cameraDistance = distance(center, cullSettings.cameraPosition);
+    if cameraDistance - radius > cullSettings.maxDistance {
+        return;
+    }
+    if cullSettings.frustumCulling != 0u && !isSphereInFrustum(center, radius) {
+        return;
+    }
+
+    // Bucket the blade into the LOD list matching its distance
+    var lod = 0u;
+    for (var i: u32 = 0u; i + 1u < cullSettings.lodCount; i = i + 1u) {
+        if cameraDistance > cullSettings.lodDistances[i] {
+            lod = i + 1u;
+        }
+    }
+
+    let visibleIndex = atomicAdd(&drawArgs[lod].instanceCount, 1u);
+    visibleBlades[lod * cullSettings.lodStride + visibleIndex] = bladeIndex;
+}
\ No newline at end of file
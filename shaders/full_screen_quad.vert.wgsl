@@ -1,3 +1,5 @@
+#include "common.wgsl"
+
 @vertex
 fn vertex_main(
     @builtin(instance_index) instanceIndex: u32,
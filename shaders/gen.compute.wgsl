@@ -1,3 +1,7 @@
+#include "common.wgsl"
+#include "noise.wgsl"
+#include "terrain.wgsl"
+
 // https://gist.github.com/munrocket/236ed5ba7e409b8bdf1ff6eca5dcdc39
 fn hash11(n: u32) -> u32 {
     var h = n * 747796405u + 2891336453u;
@@ -34,113 +38,93 @@ fn valueNoise2(n: vec2f) -> vec2f {
     );
 }
 
-fn mod289(x: vec2f) -> vec2f {
-    return x - floor(x * (1. / 289.)) * 289.;
-}
-
-fn mod289_3(x: vec3f) -> vec3f {
-    return x - floor(x * (1. / 289.)) * 289.;
-}
+@group(0) @binding(0) var<storage, read_write> staticBlades: array<StoredBladeStatic>;
+@group(0) @binding(1) var<storage, read_write> dynamicBlades: array<StoredBladeDynamic>;
+@group(2) @binding(0) var<uniform> chunk: Chunk;
 
-fn permute3(x: vec3f) -> vec3f {
-    return mod289_3(((x * 34.) + 1.) * x);
+// Central differences over one heightmap texel
+fn sampleTerrainNormal(xz: vec2f) -> vec3f {
+    let texelSize = genSettings.terrainSize / f32(textureDimensions(terrainHeightmap).x);
+    let dx = sampleTerrainHeight(xz + vec2f(texelSize, 0.0)) - sampleTerrainHeight(xz - vec2f(texelSize, 0.0));
+    let dz = sampleTerrainHeight(xz + vec2f(0.0, texelSize)) - sampleTerrainHeight(xz - vec2f(0.0, texelSize));
+    return normalize(vec3f(-dx, 2.0 * texelSize, -dz));
 }
 
-fn simplexNoise2(v: vec2f) -> f32 {
-    let C = vec4(
-        0.211324865405187, // (3.0-sqrt(3.0))/6.0
-        0.366025403784439, // 0.5*(sqrt(3.0)-1.0)
-        -0.577350269189626, // -1.0 + 2.0 * C.x
-        0.024390243902439 // 1.0 / 41.0
-    );
-
-    // First corner
-    var i = floor(v + dot(v, C.yy));
-    let x0 = v - i + dot(i, C.xx);
-
-    // Other corners
-    var i1 = select(vec2(0., 1.), vec2(1., 0.), x0.x > x0.y);
-
-    // x0 = x0 - 0.0 + 0.0 * C.xx ;
-    // x1 = x0 - i1 + 1.0 * C.xx ;
-    // x2 = x0 - 1.0 + 2.0 * C.xx ;
-    var x12 = x0.xyxy + C.xxzz;
-    x12.x = x12.x - i1.x;
-    x12.y = x12.y - i1.y;
-
-    // Permutations
-    i = mod289(i); // Avoid truncation effects in permutation
-
-    var p = permute3(permute3(i.y + vec3(0., i1.y, 1.)) + i.x + vec3(0., i1.x, 1.));
-    var m = max(0.5 - vec3(dot(x0, x0), dot(x12.xy, x12.xy), dot(x12.zw, x12.zw)), vec3(0.));
-    m *= m;
-    m *= m;
-
-    // Gradients: 41 points uniformly over a line, mapped onto a diamond.
-    // The ring size 17*17 = 289 is close to a multiple of 41 (41*7 = 287)
-    let x = 2. * fract(p * C.www) - 1.;
-    let h = abs(x) - 0.5;
-    let ox = floor(x + 0.5);
-    let a0 = x - ox;
-
-    // Normalize gradients implicitly by scaling m
-    // Approximation of: m *= inversesqrt( a0*a0 + h*h );
-    m *= 1.79284291400159 - 0.85373472095314 * (a0 * a0 + h * h);
-
-    // Compute final noise value at P
-    let g = vec3(a0.x * x0.x + h.x * x0.y, a0.yz * x12.xz + h.yz * x12.yw);
-    return 130. * dot(m, g);
+// Returns the blade height (x) and its normalized variation (y)
+fn getBladeHeight(rootXZ: vec2f) -> vec2f {
+    var randomYSizeAddition = 0.25 * simplexNoise2(rootXZ * genSettings.sizeNoiseFrequency * 0.25) + 0.5 * simplexNoise2(rootXZ * genSettings.sizeNoiseFrequency * 2.0) + 0.25 * simplexNoise2(rootXZ * genSettings.sizeNoiseFrequency * 4.0);
+    // Normalizing simplex noise
+    randomYSizeAddition = randomYSizeAddition * 0.5 + 0.5;
+    return vec2f(genSettings.bladeHeight + randomYSizeAddition * genSettings.sizeNoiseAmplitude, randomYSizeAddition);
 }
 
-struct GenSettings {
-    sideLength: f32,
-    density: f32,
-    maxNoisePositionOffset: f32,
-    sizeNoiseFrequency: f32,
-    bladeHeight: f32,
-    sizeNoiseAmplitude: f32
-};
-
-@group(0) @binding(0) var<storage, read_write> bladePositions: array<Blade>;
-@group(1) @binding(0) var<uniform> genSettings: GenSettings;
-
 @compute
-@workgroup_size(1, 1, 1)
+@workgroup_size(WORKGROUP_SIZE_X, WORKGROUP_SIZE_Y, 1)
 fn main(
+    @builtin(global_invocation_id) global_id: vec3<u32>,
     @builtin(workgroup_id) workgroup_id: vec3<u32>,
     @builtin(local_invocation_index) local_invocation_index: u32,
     @builtin(num_workgroups) num_workgroups: vec3<u32>
 ) {
     // Check if the index is within bounds
-    let workgroup_index = workgroup_id.x + workgroup_id.y * num_workgroups.x + workgroup_id.z * num_workgroups.x * num_workgroups.y;
-    let global_invocation_index = workgroup_index + local_invocation_index;
-    if global_invocation_index >= num_workgroups.x * num_workgroups.y {
+    let cell = getBladeCell(global_id, workgroup_id, local_invocation_index, num_workgroups, chunk.bladesPerSide);
+    if !isCellInBounds(cell, chunk.cellCount) {
         return;
     }
+    let global_invocation_index = chunk.firstBlade + cell.z;
+    let fieldCell = chunk.cellOffset + vec2i(cell.xy);
 
     // Chunk
-    var pos: vec3f = vec3f(-genSettings.sideLength + f32(workgroup_id.x) / genSettings.density,
+    var pos: vec3f = vec3f(-genSettings.sideLength + f32(fieldCell.x) / genSettings.density,
         0.0,
-        -genSettings.sideLength + f32(workgroup_id.y) / genSettings.density);
+        -genSettings.sideLength + f32(fieldCell.y) / genSettings.density);
     let n = (valueNoise2(pos.xz * vec2f(genSettings.density)) - 0.5) * genSettings.maxNoisePositionOffset;
     pos.x += n.x;
     pos.z += n.y;
-    // lazy heightMap simulation
-    let h = 0.75 * simplexNoise2(pos.xz * 0.075 + vec2f(10.5, 89.0)) + 0.25 * simplexNoise2(pos.xz * 0.3 + vec2f(10.5, 89.0));
-    pos.y = h;
+    pos.y = sampleTerrainHeight(pos.xz);
+    let up = sampleTerrainNormal(pos.xz);
 
-    var randomYSizeAddition = 0.25 * simplexNoise2(pos.xz * genSettings.sizeNoiseFrequency * 0.25) + 0.5 * simplexNoise2(pos.xz * genSettings.sizeNoiseFrequency * 2.0) + 0.25 * simplexNoise2(pos.xz * genSettings.sizeNoiseFrequency * 4.0);
-    // Normalizing simplex noise
-    randomYSizeAddition = randomYSizeAddition * 0.5 + 0.5;
-    let height = genSettings.bladeHeight + randomYSizeAddition * genSettings.sizeNoiseAmplitude;
+    let bladeHeight = getBladeHeight(pos.xz);
+    let height = bladeHeight.x;
 
-    let randValue = rand11(f32(global_invocation_index));
-    var blade: Blade;
+    // Seeded by the world cell so a streamed chunk always gets the same blades back
+    let randValue = f32(hash22(bitcast<vec2u>(fieldCell))) / f32(0xffffffff);
+    var blade: BladeStatic;
     blade.c0 = pos;
     blade.height = height;
-    blade.relativeHeight = randomYSizeAddition;
-    blade.facingDirection = vec3f(cos(randValue * radians(720.0)), 0.0, sin(randValue * radians(720.0)));
+    blade.relativeHeight = bladeHeight.y;
+    blade.facingDirection = vec2f(cos(randValue * radians(720.0)), sin(randValue * radians(720.0)));
     blade.idHash = randValue;
+    blade.up = up;
+
+    staticBlades[global_invocation_index] = packBladeStatic(blade);
+
+    // Straight blade until the next movement step
+    var bladeState: BladeDynamic;
+    bladeState.c1 = pos + height * up;
+    bladeState.c2 = pos + 0.25 * height * up;
+    bladeState.collisionStrength = 0.0;
+    dynamicBlades[global_invocation_index] = packBladeDynamic(bladeState, pos, up);
+}
+
+// Height settings only, roots and facing directions are kept. Movement rebuilds c1 and c2 from the new height.
+@compute
+@workgroup_size(WORKGROUP_SIZE_X, WORKGROUP_SIZE_Y, 1)
+fn updateHeight(
+    @builtin(global_invocation_id) global_id: vec3<u32>,
+    @builtin(workgroup_id) workgroup_id: vec3<u32>,
+    @builtin(local_invocation_index) local_invocation_index: u32,
+    @builtin(num_workgroups) num_workgroups: vec3<u32>
+) {
+    let cell = getBladeCell(global_id, workgroup_id, local_invocation_index, num_workgroups, chunk.bladesPerSide);
+    if !isCellInBounds(cell, chunk.cellCount) {
+        return;
+    }
+    let global_invocation_index = chunk.firstBlade + cell.z;
 
-    bladePositions[global_invocation_index] = blade;
+    var blade = unpackBladeStatic(staticBlades[global_invocation_index]);
+    let bladeHeight = getBladeHeight(blade.c0.xz);
+    blade.height = bladeHeight.x;
+    blade.relativeHeight = bladeHeight.y;
+    staticBlades[global_invocation_index] = packBladeStatic(blade);
 }
\ No newline at end of file
@@ -0,0 +1,13 @@
+// Grass generation settings, mirrors grass::GrassGenUniformData in uniforms.h
+
+struct GenSettings {
+    sideLength: f32,
+    density: f32,
+    maxNoisePositionOffset: f32,
+    sizeNoiseFrequency: f32,
+    bladeHeight: f32,
+    sizeNoiseAmplitude: f32,
+    terrainOrigin: vec2f,
+    terrainSize: f32,
+    terrainHeightScale: f32,
+};
\ No newline at end of file
@@ -1,5 +1,7 @@
+#include "common.wgsl"
+
 @group(0) @binding(0) var<uniform> global: Global;
-@group(2) @binding(0) var<uniform> model: mat4x4f;
+@group(2) @binding(0) var<storage, read> models: array<mat4x4f>; // one per instance, batch after batch
 
 
 @vertex
@@ -9,6 +11,7 @@ fn vertex_main(
     @location(1) normal: vec3f,
     @location(2) texCoord: vec2f
 ) -> VertexOut {
+    let model = models[instanceIndex];
     let worldPos = model * vec4(pos, 1.0);
     let worldNormal = model * vec4(normal, 0.0);
     var output: VertexOut;
@@ -1,3 +1,5 @@
+#include "common.wgsl"
+
 struct SSSUniform {
     max_steps: u32,
     ray_max_distance: f32,
@@ -6,7 +8,6 @@ struct SSSUniform {
 }
 
 @group(0) @binding(0) var<uniform> global: Global;
-@group(1) @binding(0) var depthTex: texture_depth_multisampled_2d;
 @group(1) @binding(1) var<uniform> s: SSSUniform;
 @group(1) @binding(2) var shadowTex: texture_storage_2d<rgba8unorm, write>;
 
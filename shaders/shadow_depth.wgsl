@@ -0,0 +1,2 @@
+// Scene depth without MSAA, see screen_space_shadows.frag.wgsl
+@group(1) @binding(0) var depthTex: texture_depth_2d;
\ No newline at end of file
@@ -0,0 +1,2 @@
+// Scene depth with MSAA, shadows read the first sample
+@group(1) @binding(0) var depthTex: texture_depth_multisampled_2d;
\ No newline at end of file
@@ -1,3 +1,5 @@
+#include "common.wgsl"
+
 @group(0) @binding(0) var<uniform> global: Global;
 
 fn easeOutExpo(x: f32) -> f32 {
@@ -0,0 +1,42 @@
+#include "gen_settings.wgsl"
+#include "noise.wgsl"
+
+// Bakes the procedural terrain into the heightmap sampled by gen.compute.wgsl
+
+// Set by ComputeManager for infinite terrain, which samples the heightmap with repeat addressing
+override TILEABLE: bool = false;
+
+@group(0) @binding(0) var<uniform> genSettings: GenSettings;
+@group(0) @binding(1) var terrainHeightmap: texture_storage_2d<rgba16float, write>;
+
+fn terrainNoise(pos: vec2f) -> f32 {
+    return 0.75 * simplexNoise2(pos * 0.075 + vec2f(10.5, 89.0)) + 0.25 * simplexNoise2(pos * 0.3 + vec2f(10.5, 89.0));
+}
+
+@compute
+@workgroup_size(8, 8, 1)
+fn main(@builtin(global_invocation_id) global_id: vec3<u32>) {
+    let resolution = textureDimensions(terrainHeightmap);
+    if global_id.x >= resolution.x || global_id.y >= resolution.y {
+        return;
+    }
+    let texelSize = genSettings.terrainSize / f32(resolution.x);
+    let fieldPos = (vec2f(global_id.xy) + 0.5) * texelSize;
+    let pos = genSettings.terrainOrigin + fieldPos;
+
+    var h = terrainNoise(pos);
+    if TILEABLE {
+        // Cross-fades with the noise one period away on each axis, both edges then meet the same values.
+        // The weights are renormalized so the blend keeps the noise contrast, clamped to the baked height range.
+        let period = genSettings.terrainSize;
+        let w = fieldPos / period;
+        let h10 = terrainNoise(pos - vec2f(period, 0.0));
+        let h01 = terrainNoise(pos - vec2f(0.0, period));
+        let h11 = terrainNoise(pos - vec2f(period, period));
+        let blended = mix(mix(h, h10, w.x), mix(h01, h11, w.x), w.y);
+        let wx = vec2f(w.x, 1.0 - w.x);
+        let wy = vec2f(w.y, 1.0 - w.y);
+        h = clamp(blended / (length(wx) * length(wy)), -1.0, 1.0);
+    }
+    textureStore(terrainHeightmap, global_id.xy, vec4f(h / genSettings.terrainHeightScale, 0.0, 0.0, 1.0));
+}
\ No newline at end of file
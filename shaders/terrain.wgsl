@@ -0,0 +1,12 @@
+#include "gen_settings.wgsl"
+
+// Terrain heightmap baked or loaded by ComputeManager::createTerrain, sampled by the passes placing blades on it
+
+@group(1) @binding(0) var<uniform> genSettings: GenSettings;
+@group(1) @binding(1) var terrainHeightmap: texture_2d<f32>;
+@group(1) @binding(2) var terrainSampler: sampler;
+
+fn sampleTerrainHeight(xz: vec2f) -> f32 {
+    let uv = (xz - genSettings.terrainOrigin) / genSettings.terrainSize;
+    return textureSampleLevel(terrainHeightmap, terrainSampler, uv, 0.0).r * genSettings.terrainHeightScale;
+}
\ No newline at end of file
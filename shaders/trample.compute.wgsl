@@ -0,0 +1,81 @@
+#include "colliders.wgsl"
+#include "terrain.wgsl"
+#include "trample.wgsl"
+
+// Stamps the colliders into the trample map once per texel, the movement pass then reads one texel per blade.
+// Sphere and capsule collisions :
+// https://www.cg.tuwien.ac.at/research/publications/2016/JAHRMANN-2016-IGR/JAHRMANN-2016-IGR-thesis.pdf
+// https://www.cg.tuwien.ac.at/research/publications/2017/JAHRMANN-2017-RRTG/JAHRMANN-2017-RRTG-draft.pdf
+
+const UP = vec3f(0.0, 1.0, 0.0);
+
+@group(0) @binding(0) var<uniform> trampleFrame: TrampleFrame;
+@group(0) @binding(1) var previousTrampleMap: texture_2d<f32>;
+@group(0) @binding(2) var trampleMap: texture_storage_2d<rgba16float, write>;
+@group(2) @binding(0) var<uniform> colliderGrid: ColliderGrid;
+@group(2) @binding(1) var<storage, read> colliders: array<Collider>;
+@group(2) @binding(2) var<storage, read> colliderCellCounts: array<u32>;
+@group(2) @binding(3) var<storage, read> colliderCells: array<u32>;
+
+fn calcSphereTranslation(p: vec3f, c: vec3f, r: f32) -> vec3f {
+    var dist = distance(c, p);
+    return min(dist - r, 0.0) * (c - p) / dist;
+}
+
+// Capsules push like the sphere of their segment closest to the point
+fn calcColliderTranslation(p: vec3f, collider: Collider) -> vec3f {
+    return calcSphereTranslation(p, getClosestColliderCenter(collider, p), collider.radius);
+}
+
+@compute
+@workgroup_size(8, 8, 1)
+fn main(@builtin(global_invocation_id) global_id: vec3<u32>) {
+    if global_id.x >= trampleFrame.resolution || global_id.y >= trampleFrame.resolution {
+        return;
+    }
+    let mapTexel = vec2i(global_id.xy);
+    let worldTexel = getTrampleMapWorldTexel(trampleFrame.originTexel, trampleFrame.resolution, mapTexel);
+
+    // A map texel recycled for another world texel starts without trail
+    var trample = vec4f(0.0);
+    let previousWorldTexel = getTrampleMapWorldTexel(trampleFrame.previousOriginTexel, trampleFrame.resolution,
+                                                     mapTexel);
+    if all(worldTexel == previousWorldTexel) {
+        trample = textureLoad(previousTrampleMap, mapTexel, 0) * trampleFrame.decay;
+    }
+
+    // Upright blade of the reference height rooted at the texel center
+    let xz = (vec2f(worldTexel) + 0.5) * trampleFrame.texelSize;
+    let c0 = vec3f(xz.x, sampleTerrainHeight(xz), xz.y);
+    let height = trampleFrame.bladeHeight;
+    let c1 = c0 + height * UP;
+    // Curve middle point, with c2 at a quarter of the height like an untilted blade
+    let m = c0 + 0.375 * height * UP;
+
+    // Only the colliders binned in the texel cell can reach it
+    let colliderCell = getColliderCell(colliderGrid, xz);
+    var cellColliderCount = 0u;
+    var firstCellCollider = 0u;
+    if isColliderCellInGrid(colliderGrid, colliderCell) {
+        let cellIndex = getColliderCellIndex(colliderGrid, colliderCell);
+        cellColliderCount = min(colliderCellCounts[cellIndex], colliderGrid.maxCellColliders);
+        firstCellCollider = cellIndex * colliderGrid.maxCellColliders;
+    }
+    var t = vec3f(0.0);
+    var strength = 0.0;
+    for (var i: u32 = 0u; i < cellColliderCount; i = i + 1u) {
+        let collider = colliders[colliderCells[firstCellCollider + i]];
+        let d = distance(c0, getClosestColliderCenter(collider, c0));
+        if d < height + collider.radius {
+            let colliderT = calcColliderTranslation(c1, collider) + 4.0 * calcColliderTranslation(m, collider);
+            t += colliderT;
+            strength = max(length(colliderT) / collider.radius, strength);
+        }
+    }
+
+    // The fading trail is kept until a stronger push replaces it
+    if strength > trample.w {
+        trample = vec4f(t, strength);
+    }
+    textureStore(trampleMap, mapTexel, trample);
+}
\ No newline at end of file
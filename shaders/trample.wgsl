@@ -0,0 +1,33 @@
+// Trample map stamped by the colliders, see ComputeManager::computeMovement.
+// It covers a window of world texels around the camera and wraps around toroidally : a world texel always lands in
+// the same map texel, so the trails don't move when the window follows the camera.
+
+struct TrampleFrame {
+    originTexel: vec2i, // world texel of the window corner
+    previousOriginTexel: vec2i, // last frame window corner, the map texels it no longer covers are reset
+    texelSize: f32,
+    resolution: u32,
+    decay: f32, // fraction of the trails left since the last frame
+    bladeHeight: f32, // displacements are stamped for a blade that tall
+};
+
+
+fn getTrampleWorldTexel(texelSize: f32, xz: vec2f) -> vec2i {
+    return vec2i(floor(xz / texelSize));
+}
+
+fn isInTrampleWindow(originTexel: vec2i, resolution: u32, worldTexel: vec2i) -> bool {
+    let offset = worldTexel - originTexel;
+    return all(offset >= vec2i(0)) && all(offset < vec2i(i32(resolution)));
+}
+
+// Map texel holding a world texel
+fn getTrampleMapTexel(resolution: u32, worldTexel: vec2i) -> vec2i {
+    let size = i32(resolution);
+    return ((worldTexel % size) + size) % size;
+}
+
+// World texel held by a map texel for a window corner
+fn getTrampleMapWorldTexel(originTexel: vec2i, resolution: u32, mapTexel: vec2i) -> vec2i {
+    return originTexel + getTrampleMapTexel(resolution, mapTexel - originTexel);
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#include "noise.wgsl"
+
+// Wind noise of move.compute.wgsl evaluated once per texel, in a texture following the camera
+
+struct MovSettings {
+    wind: vec4f,
+    windFrequency: f32,
+};
+
+struct MovFrame {
+    time: f32,
+    windFieldSize: f32,
+    windFieldOrigin: vec2f,
+};
+
+@group(0) @binding(0) var<uniform> movSettings: MovSettings;
+@group(0) @binding(1) var<uniform> movFrame: MovFrame;
+@group(0) @binding(2) var windField: texture_storage_2d<rgba16float, write>;
+
+@compute
+@workgroup_size(8, 8, 1)
+fn main(@builtin(global_invocation_id) global_id: vec3<u32>) {
+    let resolution = textureDimensions(windField);
+    if global_id.x >= resolution.x || global_id.y >= resolution.y {
+        return;
+    }
+    let texelSize = movFrame.windFieldSize / f32(resolution.x);
+    let pos = movFrame.windFieldOrigin + (vec2f(global_id.xy) + 0.5) * texelSize;
+
+    var noisePhase = movFrame.time * movSettings.windFrequency * movSettings.wind.xyz;
+    var windNoise = 0.5 + 0.5 * (simplexNoise2(pos * 0.1 - noisePhase.xz) * 0.5 + simplexNoise2(pos * 0.5 - noisePhase.xz) * 0.1 + simplexNoise2(pos * 3.5 - noisePhase.xz) * 0.4);
+    textureStore(windField, global_id.xy, vec4f(windNoise, 0.0, 0.0, 1.0));
+}
\ No newline at end of file
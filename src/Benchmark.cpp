@@ -0,0 +1,344 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "ComputeManager.h"
+#include "GPUContext.h"
+#include "Mesh.h"
+#include "MeshFile.h"
+#include "MeshOptimizer.h"
+#include "Renderer.h"
+#include "Utils.h"
+
+
+namespace grass
+{
+    namespace
+    {
+        struct CameraKey
+        {
+            glm::vec3 position;
+            glm::vec3 direction;
+        };
+
+        // Loop around the preview scene, high enough to stay above the terrain
+        const std::array<CameraKey, 6> CAMERA_PATH = {
+            CameraKey{{3.8, 2.6, 3.1}, {-0.8, -0.35, -0.5}},
+            CameraKey{{0.0, 2.2, 5.5}, {0.1, -0.3, -1.0}},
+            CameraKey{{-4.5, 3.0, 2.5}, {0.9, -0.4, -0.3}},
+            CameraKey{{-3.5, 3.5, -3.5}, {0.6, -0.5, 0.6}},
+            CameraKey{{1.5, 2.4, -4.5}, {-0.2, -0.3, 1.0}},
+            CameraKey{{5.5, 3.0, -1.0}, {-1.0, -0.4, 0.2}},
+        };
+
+
+        template <typename T>
+        T catmullRom(const T& p0, const T& p1, const T& p2, const T& p3, float t)
+        {
+            const float t2 = t * t;
+            const float t3 = t2 * t;
+            return 0.5f * (2.0f * p1 + (p2 - p0) * t + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
+                (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+        }
+
+
+        // Nearest-rank percentile of sorted samples
+        float percentile(const std::vector<float>& sortedSamples, float p)
+        {
+            if (sortedSamples.empty()) return 0.0;
+            const auto rank = static_cast<size_t>(std::ceil(p * static_cast<float>(sortedSamples.size())));
+            return sortedSamples[std::clamp<size_t>(rank, 1, sortedSamples.size()) - 1];
+        }
+    }
+
+
+    Benchmark::Benchmark(Settings settings) : settings(std::move(settings))
+    {
+    }
+
+
+    std::vector<BenchmarkScenario> Benchmark::getDefaultScenarios()
+    {
+        return {
+            {.name = "default"},
+            {.name = "dense", .density = 30.0},
+            {.name = "large_field", .sideLength = 30.0},
+            {.name = "no_shadows", .shadowSteps = 0},
+            {.name = "long_shadows", .shadowSteps = 64},
+            {.name = "no_msaa", .multiSample = false},
+            {.name = "full_rate_movement", .amortizedMovement = false},
+        };
+    }
+
+
+    bool Benchmark::run(const std::vector<BenchmarkScenario>& scenarios)
+    {
+        GPUContext* ctx = GPUContext::initHeadless(GlobalConfig{}.headlessFormat, settings.forceFallbackAdapter);
+        ctx->configSurface(settings.size.x, settings.size.y);
+
+        bool success = true;
+        for (const BenchmarkScenario& scenario : scenarios)
+        {
+            if (!settings.scenarioFilter.empty() && scenario.name != settings.scenarioFilter) continue;
+
+            std::cout << "Running scenario " << scenario.name << "..." << std::endl;
+            results.push_back(runScenario(scenario));
+            if (!results.back().initialized)
+            {
+                std::cerr << "Could not initialize scenario " << scenario.name << std::endl;
+                success = false;
+            }
+        }
+        return success && !results.empty();
+    }
+
+
+    BenchmarkResult Benchmark::runScenario(const BenchmarkScenario& scenario)
+    {
+        auto config = std::make_shared<GlobalConfig>();
+        config->grassUniform.sideLength = scenario.sideLength;
+        config->grassUniform.density = scenario.density;
+        config->calculateTotal();
+        config->shadowUniform.max_steps = scenario.shadowSteps;
+        config->multiSample = scenario.multiSample;
+        config->amortizedMovement = scenario.amortizedMovement;
+        config->headless = true;
+        config->headlessSize = settings.size;
+
+        BenchmarkResult result = {
+            .scenario = scenario,
+            .totalBlades = config->getBladeCount(),
+            .chunkCount = config->chunkCount,
+        };
+
+        GPUContext* ctx = GPUContext::getInstance();
+        ComputeManager computeManager(config);
+        Renderer renderer(config, static_cast<uint16_t>(settings.size.x), static_cast<uint16_t>(settings.size.y));
+        // Cold or warm depending on the pipeline cache
+        const auto startupStart = std::chrono::steady_clock::now();
+        StartupScheduler scheduler;
+        auto portalImage = scheduler.load([] { return loadImageData("../assets/portal_color.png"); });
+        auto portalMeshFile = scheduler.load([] { return MeshFile::import("../assets/portal.obj"); });
+
+        const BladeBuffers bladeBuffers = computeManager.init(scheduler);
+        if (bladeBuffers.staticBlades == nullptr) return result;
+        if (!renderer.init(bladeBuffers, scheduler)) return result;
+
+        // Same preview scene as the interactive renderer
+        PhongMaterial portalCol{createTexture(portalImage.get())};
+        const MeshFile portalMeshData = portalMeshFile.get();
+        if (portalMeshData.isValid())
+        {
+            const MeshFileHeader& header = portalMeshData.getHeader();
+            result.meshes.push_back({
+                .path = "../assets/portal.obj",
+                .vertexCount = header.vertexCount,
+                .triangleCount = header.indexCount / 3,
+                .vertexCacheMissRatio = getAverageCacheMissRatio(portalMeshData.getIndices(), header.vertexCount),
+            });
+        }
+        auto portalMesh = Mesh(MeshGeomoetry("../assets/portal.obj", portalMeshData), portalCol);
+        portalMesh.model = glm::translate(portalMesh.model, glm::vec3{0.61, 0.12, 0.5});
+        portalMesh.model = glm::scale(portalMesh.model, glm::vec3{0.3});
+        // Stone and pillars, in portal space
+        portalMesh.colliders = {
+            {.a = {-2.8, 1.0, 2.17}, .b = {-2.8, 1.0, 2.17}, .radius = 2.33},
+            {.a = {-2.03, 0.8, 0.12}, .b = {-2.03, 3.2, 0.12}, .radius = 0.85},
+            {.a = {2.03, 0.8, 0.04}, .b = {2.03, 3.2, 0.04}, .radius = 0.85},
+        };
+        const std::vector<Mesh> scene = {portalMesh};
+
+        if (!scheduler.wait()) return result;
+        const std::chrono::duration<float, std::milli> startupTime = std::chrono::steady_clock::now() - startupStart;
+        result.startupMs = startupTime.count();
+        result.initialized = true;
+
+        Camera camera{35.0, static_cast<float>(settings.size.x) / static_cast<float>(settings.size.y)};
+        float time = 0.0;
+        FrameGraph frameGraph;
+        computeManager.generate(frameGraph);
+        computeManager.updateMovSettingsUniorm();
+
+        GPUProfiler& profiler = ctx->getProfiler();
+        std::vector<float> frameTimes;
+        frameTimes.reserve(settings.frames);
+        size_t visibleChunkSum = 0;
+        size_t movedChunkSum = 0;
+
+        const uint32_t frameCount = settings.warmupFrames + settings.frames;
+        for (uint32_t frame = 0; frame < frameCount; frame++)
+        {
+            const bool measured = frame >= settings.warmupFrames;
+            if (frame == settings.warmupFrames) profiler.reset();
+            const auto frameStart = std::chrono::steady_clock::now();
+
+            time += DELTA_TIME;
+            const uint32_t pathFrame = measured ? frame - settings.warmupFrames : 0;
+            moveCameraAlongPath(camera, static_cast<float>(pathFrame) / static_cast<float>(settings.frames));
+            camera.updateMatrix();
+            profiler.beginFrame();
+
+            computeManager.streamChunks(frameGraph, camera);
+            computeManager.updateVisibleChunks(camera);
+            computeManager.updateHeights(frameGraph);
+            computeManager.updateColliders(scene, camera);
+            computeManager.computeMovement(frameGraph, camera, time);
+            computeManager.cullBlades(frameGraph, camera);
+            const bool rendered = renderer.render(frameGraph, scene, camera, time, frame);
+            frameGraph.execute();
+            if (rendered)
+                ctx->present();
+            ctx->processEvents();
+
+            if (measured)
+            {
+                const std::chrono::duration<float, std::milli> frameTime = std::chrono::steady_clock::now() -
+                    frameStart;
+                frameTimes.push_back(frameTime.count());
+                visibleChunkSum += computeManager.getVisibleChunkCount();
+                movedChunkSum += computeManager.getMovedChunkCount();
+            }
+        }
+        ctx->waitIdle();
+        ctx->processEvents();
+
+        if (!frameTimes.empty())
+        {
+            float sum = 0.0;
+            for (const float frameTime : frameTimes) sum += frameTime;
+            std::sort(frameTimes.begin(), frameTimes.end());
+
+            const auto measuredFrames = static_cast<float>(frameTimes.size());
+            result.avgVisibleChunks = static_cast<float>(visibleChunkSum) / measuredFrames;
+            result.avgMovedChunks = static_cast<float>(movedChunkSum) / measuredFrames;
+            result.avgMs = sum / measuredFrames;
+            result.minMs = frameTimes.front();
+            result.maxMs = frameTimes.back();
+            result.p50Ms = percentile(frameTimes, 0.50);
+            result.p90Ms = percentile(frameTimes, 0.90);
+            result.p95Ms = percentile(frameTimes, 0.95);
+            result.p99Ms = percentile(frameTimes, 0.99);
+        }
+        result.gpuTimings = profiler.getTimings();
+        profiler.reset();
+
+        return result;
+    }
+
+
+    void Benchmark::moveCameraAlongPath(Camera& camera, float t)
+    {
+        const auto keyCount = static_cast<int32_t>(CAMERA_PATH.size());
+        const float position = (t - std::floor(t)) * static_cast<float>(keyCount);
+        const auto segment = static_cast<int32_t>(position);
+        const float localT = position - static_cast<float>(segment);
+
+        const auto key = [keyCount](int32_t index) -> const CameraKey&
+        {
+            return CAMERA_PATH[(index % keyCount + keyCount) % keyCount];
+        };
+        const CameraKey& k0 = key(segment - 1);
+        const CameraKey& k1 = key(segment);
+        const CameraKey& k2 = key(segment + 1);
+        const CameraKey& k3 = key(segment + 2);
+
+        camera.position = catmullRom(k0.position, k1.position, k2.position, k3.position, localT);
+        camera.direction = glm::normalize(catmullRom(glm::normalize(k0.direction), glm::normalize(k1.direction),
+                                                     glm::normalize(k2.direction), glm::normalize(k3.direction),
+                                                     localT));
+    }
+
+
+    bool Benchmark::writeReport(const std::string& path) const
+    {
+        std::ofstream file(path);
+        if (!file.is_open())
+        {
+            std::cerr << "Could not open " << path << " to write the benchmark report" << std::endl;
+            return false;
+        }
+
+        file << std::fixed << std::setprecision(4);
+        file << "{\n";
+        file << "  \"width\": " << settings.size.x << ",\n";
+        file << "  \"height\": " << settings.size.y << ",\n";
+        file << "  \"warmupFrames\": " << settings.warmupFrames << ",\n";
+        file << "  \"frames\": " << settings.frames << ",\n";
+        file << "  \"timestampQueries\": " << (GPUContext::getInstance()->getProfiler().isEnabled() ? "true" : "false")
+            << ",\n";
+        file << "  \"scenarios\": [";
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const BenchmarkResult& result = results[i];
+            const BenchmarkScenario& scenario = result.scenario;
+            file << (i == 0 ? "\n" : ",\n");
+            file << "    {\n";
+            file << "      \"name\": \"" << scenario.name << "\",\n";
+            file << "      \"initialized\": " << (result.initialized ? "true" : "false") << ",\n";
+            file << "      \"settings\": {\"sideLength\": " << scenario.sideLength
+                << ", \"density\": " << scenario.density
+                << ", \"shadowSteps\": " << scenario.shadowSteps
+                << ", \"multiSample\": " << (scenario.multiSample ? "true" : "false")
+                << ", \"amortizedMovement\": " << (scenario.amortizedMovement ? "true" : "false") << "},\n";
+            file << "      \"blades\": {\"total\": " << result.totalBlades
+                << ", \"chunks\": " << result.chunkCount
+                << ", \"avgVisibleChunks\": " << result.avgVisibleChunks
+                << ", \"avgMovedChunks\": " << result.avgMovedChunks << "},\n";
+            file << "      \"meshes\": [";
+            for (size_t j = 0; j < result.meshes.size(); j++)
+            {
+                const BenchmarkMesh& mesh = result.meshes[j];
+                file << (j == 0 ? "\n" : ",\n");
+                file << "        {\"path\": \"" << mesh.path << "\", \"vertices\": " << mesh.vertexCount
+                    << ", \"triangles\": " << mesh.triangleCount
+                    << ", \"vertexCacheMissRatio\": " << mesh.vertexCacheMissRatio << "}";
+            }
+            file << (result.meshes.empty() ? "],\n" : "\n      ],\n");
+            file << "      \"startupMs\": " << result.startupMs << ",\n";
+            file << "      \"cpuFrameMs\": {\"avg\": " << result.avgMs
+                << ", \"min\": " << result.minMs
+                << ", \"max\": " << result.maxMs
+                << ", \"p50\": " << result.p50Ms
+                << ", \"p90\": " << result.p90Ms
+                << ", \"p95\": " << result.p95Ms
+                << ", \"p99\": " << result.p99Ms << "},\n";
+            file << "      \"gpuPassMs\": {";
+            for (size_t j = 0; j < result.gpuTimings.size(); j++)
+            {
+                const GPUProfiler::PassTiming& timing = result.gpuTimings[j];
+                file << (j == 0 ? "\n" : ",\n");
+                file << "        \"" << timing.name << "\": {\"avg\": " << timing.avgMs
+                    << ", \"min\": " << timing.minMs
+                    << ", \"max\": " << timing.maxMs << "}";
+            }
+            file << (result.gpuTimings.empty() ? "}\n" : "\n      }\n");
+            file << "    }";
+        }
+        file << (results.empty() ? "]\n" : "\n  ]\n");
+        file << "}\n";
+
+        return file.good();
+    }
+
+
+    void Benchmark::printSummary() const
+    {
+        std::cout << std::fixed << std::setprecision(3);
+        for (const BenchmarkResult& result : results)
+        {
+            if (!result.initialized) continue;
+            std::cout << result.scenario.name << ": " << result.totalBlades << " blades, startup " << result.startupMs
+                << " ms, avg " << result.avgMs << " ms, p95 " << result.p95Ms << " ms, p99 " << result.p99Ms << " ms" << std::endl;
+            for (const auto& timing : result.gpuTimings)
+            {
+                std::cout << "  " << timing.name << ": " << timing.avgMs << " ms" << std::endl;
+            }
+        }
+    }
+} // grass
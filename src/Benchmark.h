@@ -0,0 +1,87 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Camera.h"
+#include "GlobalConfig.h"
+#include "GPUProfiler.h"
+
+namespace grass
+{
+    // Settings overridden on top of the default GlobalConfig
+    struct BenchmarkScenario
+    {
+        std::string name;
+        float sideLength = 10.0;
+        float density = 15.0;
+        uint32_t shadowSteps = 32;
+        bool multiSample = true;
+        bool amortizedMovement = true;
+    };
+
+    // Imported scene mesh, its vertex cache efficiency depends on the importer's triangle ordering
+    struct BenchmarkMesh
+    {
+        std::string path;
+        uint32_t vertexCount = 0;
+        uint32_t triangleCount = 0;
+        float vertexCacheMissRatio = 0.0; // see getAverageCacheMissRatio
+    };
+
+    struct BenchmarkResult
+    {
+        BenchmarkScenario scenario;
+        bool initialized = false;
+        size_t totalBlades = 0;
+        size_t chunkCount = 0;
+        float avgVisibleChunks = 0.0;
+        float avgMovedChunks = 0.0;
+        std::vector<BenchmarkMesh> meshes;
+        // Renderer and compute initialization, until every pipeline is created
+        float startupMs = 0.0;
+        // CPU frame times in ms, including the wait on the previous frame
+        float avgMs = 0.0;
+        float minMs = 0.0;
+        float maxMs = 0.0;
+        float p50Ms = 0.0;
+        float p90Ms = 0.0;
+        float p95Ms = 0.0;
+        float p99Ms = 0.0;
+        // Profiler rolling timings, i.e. the last measured frames
+        std::vector<GPUProfiler::PassTiming> gpuTimings;
+    };
+
+    // Renders scenarios headless along a fixed camera path with a fixed time step
+    class Benchmark
+    {
+        static constexpr float DELTA_TIME = 1.0f / 60.0f;
+
+    public:
+        struct Settings
+        {
+            uint32_t warmupFrames = 60;
+            uint32_t frames = 600; // one loop of the camera path at 60 fps
+            glm::uvec2 size = {1600, 900};
+            bool forceFallbackAdapter = false;
+            std::string scenarioFilter; // runs every scenario when empty
+        };
+
+        explicit Benchmark(Settings settings);
+
+        static std::vector<BenchmarkScenario> getDefaultScenarios();
+
+        bool run(const std::vector<BenchmarkScenario>& scenarios);
+        bool writeReport(const std::string& path) const;
+        void printSummary() const;
+
+    private:
+        BenchmarkResult runScenario(const BenchmarkScenario& scenario);
+        // Closed Catmull-Rom spline through the recorded keys, t in [0, 1[
+        static void moveCameraAlongPath(Camera& camera, float t);
+
+        Settings settings;
+        std::vector<BenchmarkResult> results;
+    };
+} // grass
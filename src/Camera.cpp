@@ -1,6 +1,7 @@
 #include "Camera.h"
 
 #include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/matrix_access.hpp>
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/quaternion.hpp>
 
@@ -62,4 +63,21 @@ namespace grass
                                                 glm::angleAxis(-yawDelta, glm::vec3(0.f, 1.0f, 0.0f))));
         direction = glm::rotate(q, direction);
     }
+
+    std::array<glm::vec4, 6> Camera::getFrustumPlanes() const
+    {
+        // Gribb-Hartmann extraction from the view-projection rows
+        const glm::mat4 viewProj = projMatrix * viewMatrix;
+        const glm::vec4 r0 = glm::row(viewProj, 0);
+        const glm::vec4 r1 = glm::row(viewProj, 1);
+        const glm::vec4 r2 = glm::row(viewProj, 2);
+        const glm::vec4 r3 = glm::row(viewProj, 3);
+
+        std::array<glm::vec4, 6> planes = {r3 + r0, r3 - r0, r3 + r1, r3 - r1, r3 + r2, r3 - r2};
+        for (auto& plane : planes)
+        {
+            plane /= glm::length(glm::vec3(plane));
+        }
+        return planes;
+    }
 } // grass
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -32,6 +33,8 @@ namespace grass
         void moveUp(float deltaTime);
         void moveDown(float deltaTime);
         void updateCamDirection(float xoffset, float yoffset);
+        // Normalized planes (xyz normal pointing inside, w distance) : left, right, bottom, top, near, far
+        std::array<glm::vec4, 6> getFrustumPlanes() const;
 
         glm::mat4 viewMatrix{};
         glm::mat4 projMatrix{};
@@ -1,75 +1,346 @@
 #include "ComputeManager.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include "Hash.h"
 #include "Utils.h"
 
 namespace grass
 {
+    // The terrain baked by terrain.compute.wgsl stays within [-1, 1]
+    constexpr float BAKED_TERRAIN_HEIGHT_RANGE = 1.0f;
+    // Same margin as BOUNDS_MARGIN in cull.compute.wgsl
+    constexpr float CHUNK_BOUNDS_MARGIN = 0.1f;
+
+
+    // Tests the box corner furthest along each plane normal
+    static bool isBoxInFrustum(const std::array<glm::vec4, 6>& planes, const glm::vec3& boundsMin,
+                               const glm::vec3& boundsMax)
+    {
+        for (const glm::vec4& plane : planes)
+        {
+            const glm::vec3 corner = glm::mix(boundsMin, boundsMax, glm::greaterThan(glm::vec3(plane), glm::vec3(0.0f)));
+            if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f) return false;
+        }
+        return true;
+    }
+
+
+    // The opposite edges of a tileable heightmap differ about as much as neighbouring texels
+    static bool isHeightmapTileable(const ImageData& image)
+    {
+        if (image.width < 2 || image.height < 2) return true;
+        const auto heightAt = [&image](uint32_t x, uint32_t y)
+        {
+            return static_cast<float>(image.pixels[(static_cast<size_t>(y) * image.width + x) * 4]);
+        };
+        float seamStep = 0.0f;
+        float innerStep = 0.0f;
+        for (uint32_t y = 0; y < image.height; y++)
+        {
+            seamStep += std::abs(heightAt(image.width - 1, y) - heightAt(0, y));
+            innerStep += std::abs(heightAt(1, y) - heightAt(0, y));
+        }
+        for (uint32_t x = 0; x < image.width; x++)
+        {
+            seamStep += std::abs(heightAt(x, image.height - 1) - heightAt(x, 0));
+            innerStep += std::abs(heightAt(x, 1) - heightAt(x, 0));
+        }
+        // A few grey levels of slack per texel so flat heightmaps pass
+        return seamStep <= 4.0f * innerStep + 2.0f * static_cast<float>(image.width + image.height);
+    }
+
+
+    // Frames between two movement updates of a chunk, a power of two
+    static uint32_t getMovementInterval(const glm::vec3& intervalDistances, float distance)
+    {
+        uint32_t interval = 1;
+        for (int32_t band = 0; band < 3; band++)
+        {
+            if (distance < intervalDistances[band]) break;
+            interval *= 2;
+        }
+        return interval;
+    }
+
+
     ComputeManager::ComputeManager(std::shared_ptr<GlobalConfig> config) : config(std::move(config))
     {
         ctx = GPUContext::getInstance();
     }
 
 
-    wgpu::Buffer ComputeManager::init()
+    BladeBuffers ComputeManager::init(StartupScheduler& scheduler)
+    {
+        TRACE_ZONE("ComputeManager::init");
+        // Decoded while the buffers are created and the pipelines compile
+        std::future<ImageData> heightmapImage;
+        if (!config->terrainHeightmapPath.empty())
+        {
+            heightmapImage = scheduler.load([path = config->terrainHeightmapPath] { return loadImageData(path); });
+        }
+
+        initDispatchConstants();
+        if (!createBladeBuffers()) return {};
+        // Generation writes everything, movement only writes the dynamic stream and culling only reads
+        if (!createBladeBindGroup(wgpu::BufferBindingType::Storage, wgpu::BufferBindingType::Storage,
+                                  "Generation blades bind group", genBladeBinding))
+            return {};
+        if (!createBladeBindGroup(wgpu::BufferBindingType::ReadOnlyStorage, wgpu::BufferBindingType::Storage,
+                                  "Movement blades bind group", movBladeBinding))
+            return {};
+        if (!createBladeBindGroup(wgpu::BufferBindingType::ReadOnlyStorage,
+                                  wgpu::BufferBindingType::ReadOnlyStorage,
+                                  "Culling blades bind group", cullBladeBinding))
+            return {};
+        if (!createChunks()) return {};
+        if (!createUniformBuffers()) return {};
+        if (!createWindField(scheduler)) return {};
+        if (!createColliderBuffers(scheduler)) return {};
+        if (!createTrampleMap()) return {};
+        if (!createCullBuffers()) return {};
+        if (!initMovPipeline(scheduler)) return {};
+        if (!initCullPipeline(scheduler)) return {};
+        if (!createTerrain(scheduler, heightmapImage)) return {};
+        // Generation and stamping sample the terrain
+        if (!createTerrainSampleBindGroup()) return {};
+        if (!initTramplePipeline(scheduler)) return {};
+        if (!initGenPipeline(scheduler)) return {};
+
+        return {staticBladeBuffer, dynamicBladeBuffer, visibleBladesBuffer, lodStride, drawArgsBuffer};
+    }
+
+
+    void ComputeManager::initDispatchConstants()
+    {
+        const bool tiled = config->dispatchMode == DispatchMode::Tiled;
+        const glm::uvec2 workgroupSize = tiled ? config->tiledWorkgroupSize : glm::uvec2{config->linearWorkgroupSize, 1};
+        dispatchConstants = {
+            wgpu::ConstantEntry{.key = "WORKGROUP_SIZE_X", .value = static_cast<double>(workgroupSize.x)},
+            wgpu::ConstantEntry{.key = "WORKGROUP_SIZE_Y", .value = static_cast<double>(workgroupSize.y)},
+            wgpu::ConstantEntry{.key = "TILED_DISPATCH", .value = tiled ? 1.0 : 0.0},
+        };
+    }
+
+
+    void ComputeManager::dispatchBlades(const wgpu::ComputePassEncoder& pass) const
     {
-        if (!createSharedBuffer()) return nullptr;
-        if (!createSharedBindGroup()) return nullptr;
-        if (!createUniformBuffers()) return nullptr;
-        if (!initGenPipeline()) return nullptr;
-        if (!initMovPipeline()) return nullptr;
+        const auto bladesPerSide = static_cast<uint32_t>(config->chunkBladesPerSide);
+        if (config->dispatchMode == DispatchMode::Tiled)
+        {
+            const glm::uvec2 size = config->tiledWorkgroupSize;
+            pass.DispatchWorkgroups((bladesPerSide + size.x - 1) / size.x, (bladesPerSide + size.y - 1) / size.y, 1);
+            return;
+        }
+
+        // Fold the workgroups into rows so huge fields don't exceed the per-dimension limit
+        const uint32_t workgroupCount = (bladesPerSide * bladesPerSide + config->linearWorkgroupSize - 1) /
+            config->linearWorkgroupSize;
+        const uint32_t rowLength = std::min(workgroupCount, ctx->getLimits().maxComputeWorkgroupsPerDimension);
+        pass.DispatchWorkgroups(rowLength, (workgroupCount + rowLength - 1) / rowLength, 1);
+    }
 
-        return computeBuffer;
+
+    void ComputeManager::dispatchChunks(const wgpu::ComputePassEncoder& pass,
+                                        const std::vector<uint32_t>& chunkIndices) const
+    {
+        for (const uint32_t chunkIndex : chunkIndices)
+        {
+            pass.SetBindGroup(2, chunkBindGroup, 1, &chunks[chunkIndex].uniformOffset);
+            dispatchBlades(pass);
+        }
     }
 
 
-    bool ComputeManager::createSharedBuffer()
+    bool ComputeManager::createBladeBuffers()
     {
-        wgpu::BufferDescriptor sharedComputeBufferDesc = {
-            .label = "Grass blade instance info storage buffer",
+        const size_t staticBladeSize = config->packedBlades ? sizeof(PackedBladeStatic) : sizeof(BladeStatic);
+        const size_t dynamicBladeSize = config->packedBlades ? sizeof(PackedBladeDynamic) : sizeof(BladeDynamic);
+
+        wgpu::BufferDescriptor staticBladeBufferDesc = {
+            .label = "Grass blade static storage buffer",
             .usage = wgpu::BufferUsage::Storage,
-            .size = sizeof(Blade) * config->totalBlades,
+            .size = staticBladeSize * config->bladeCapacity,
             .mappedAtCreation = false
         };
-        computeBuffer = ctx->getDevice().CreateBuffer(&sharedComputeBufferDesc);
+        staticBladeBuffer = ctx->getDevice().CreateBuffer(&staticBladeBufferDesc);
+
+        wgpu::BufferDescriptor dynamicBladeBufferDesc = {
+            .label = "Grass blade dynamic storage buffer",
+            .usage = wgpu::BufferUsage::Storage,
+            .size = dynamicBladeSize * config->bladeCapacity,
+            .mappedAtCreation = false
+        };
+        dynamicBladeBuffer = ctx->getDevice().CreateBuffer(&dynamicBladeBufferDesc);
+
+        return staticBladeBuffer != nullptr && dynamicBladeBuffer != nullptr;
+    }
+
+
+    bool ComputeManager::createBladeBindGroup(wgpu::BufferBindingType staticType,
+                                              wgpu::BufferBindingType dynamicType, const char* label,
+                                              BladeBinding& binding)
+    {
+        wgpu::BindGroupLayoutEntry entryLayouts[2] = {
+            {
+                .binding = 0,
+                .visibility = wgpu::ShaderStage::Compute,
+                .buffer = {
+                    .type = staticType,
+                    .minBindingSize = staticBladeBuffer.GetSize()
+                }
+            },
+            {
+                .binding = 1,
+                .visibility = wgpu::ShaderStage::Compute,
+                .buffer = {
+                    .type = dynamicType,
+                    .minBindingSize = dynamicBladeBuffer.GetSize()
+                }
+            }
+        };
+        wgpu::BindGroupLayoutDescriptor bladeBindGroupLayoutDesc = {
+            .label = label,
+            .entryCount = 2,
+            .entries = &entryLayouts[0]
+        };
+        binding.layout = ctx->getObjectCache().getBindGroupLayout(bladeBindGroupLayoutDesc);
 
-        return computeBuffer != nullptr;
+
+        wgpu::BindGroupEntry entries[2] = {
+            {
+                .binding = 0,
+                .buffer = staticBladeBuffer,
+                .offset = 0,
+                .size = staticBladeBuffer.GetSize()
+            },
+            {
+                .binding = 1,
+                .buffer = dynamicBladeBuffer,
+                .offset = 0,
+                .size = dynamicBladeBuffer.GetSize()
+            }
+        };
+
+        wgpu::BindGroupDescriptor bladeBindGroupDesc = {
+            .label = label,
+            .layout = binding.layout,
+            .entryCount = 2,
+            .entries = &entries[0]
+        };
+        binding.bindGroup = ctx->getDevice().CreateBindGroup(&bladeBindGroupDesc);
+
+        return binding.layout != nullptr && binding.bindGroup != nullptr;
     }
 
 
-    bool ComputeManager::createSharedBindGroup()
+    bool ComputeManager::createChunks()
     {
-        wgpu::BindGroupLayoutEntry entryLayout = {
+        const uint64_t alignment = ctx->getLimits().minUniformBufferOffsetAlignment;
+        chunkStride = (sizeof(ChunkUniformData) + alignment - 1) / alignment * alignment;
+        const auto chunksPerSide = static_cast<uint32_t>(config->chunksPerSide);
+
+        wgpu::BufferDescriptor chunkUniformBufferDesc = {
+            .label = "Chunk uniform buffer",
+            .usage = wgpu::BufferUsage::Uniform | wgpu::BufferUsage::CopyDst,
+            .size = chunkStride * config->chunkCount,
+            .mappedAtCreation = false
+        };
+        chunkUniformBuffer = ctx->getDevice().CreateBuffer(&chunkUniformBufferDesc);
+        if (chunkUniformBuffer == nullptr) return false;
+
+        chunks.resize(config->chunkCount);
+        allChunks.clear();
+        for (uint32_t y = 0; y < chunksPerSide; y++)
+        {
+            for (uint32_t x = 0; x < chunksPerSide; x++)
+            {
+                // The ring starts as the fixed field, centered on the world origin
+                const uint32_t chunkIndex = y * chunksPerSide + x;
+                setChunkCoord(chunkIndex, glm::ivec2{x, y});
+                allChunks.push_back(chunkIndex);
+            }
+        }
+        // Everything is visible until the first camera update
+        visibleChunks = allChunks;
+        updateChunkBounds(allChunks);
+
+        wgpu::BindGroupLayoutEntry chunkEntryLayout = {
             .binding = 0,
             .visibility = wgpu::ShaderStage::Compute,
             .buffer = {
-                .type = wgpu::BufferBindingType::Storage,
-                .minBindingSize = computeBuffer.GetSize()
+                .type = wgpu::BufferBindingType::Uniform,
+                .hasDynamicOffset = true,
+                .minBindingSize = sizeof(ChunkUniformData)
             }
         };
-        wgpu::BindGroupLayoutDescriptor sharedBindGroupLayoutDesc = {
-            .label = "Shared compute bind group layout",
+        wgpu::BindGroupLayoutDescriptor chunkBindGroupLayoutDesc = {
+            .label = "Chunk bind group layout",
             .entryCount = 1,
-            .entries = &entryLayout
+            .entries = &chunkEntryLayout
         };
-        sharedLayout = ctx->getDevice().CreateBindGroupLayout(&sharedBindGroupLayoutDesc);
+        chunkBindGroupLayout = ctx->getObjectCache().getBindGroupLayout(chunkBindGroupLayoutDesc);
 
-
-        wgpu::BindGroupEntry entry = {
+        wgpu::BindGroupEntry chunkEntry = {
             .binding = 0,
-            .buffer = computeBuffer,
+            .buffer = chunkUniformBuffer,
             .offset = 0,
-            .size = computeBuffer.GetSize()
+            .size = sizeof(ChunkUniformData),
         };
-
-        wgpu::BindGroupDescriptor sharedBindGroupDesc = {
-            .label = "Shared compute bind group",
-            .layout = sharedLayout,
+        wgpu::BindGroupDescriptor chunkBindGroupDesc = {
+            .label = "Chunk bind group",
+            .layout = chunkBindGroupLayout,
             .entryCount = 1,
-            .entries = &entry
+            .entries = &chunkEntry
         };
-        sharedBindGroup = ctx->getDevice().CreateBindGroup(&sharedBindGroupDesc);
+        chunkBindGroup = ctx->getDevice().CreateBindGroup(&chunkBindGroupDesc);
+
+        return chunkBindGroupLayout != nullptr && chunkBindGroup != nullptr;
+    }
+
+
+    void ComputeManager::setChunkCoord(uint32_t chunkIndex, const glm::ivec2& coord)
+    {
+        const auto bladesPerSide = static_cast<int32_t>(config->bladesPerSide);
+        const auto chunkBladesPerSide = static_cast<int32_t>(config->chunkBladesPerSide);
+
+        GrassChunk& chunk = chunks[chunkIndex];
+        chunk.coord = coord;
+        chunk.uniform.cellOffset = coord * chunkBladesPerSide;
+        // Border chunks of the fixed field are cut, streamed chunks are always full
+        chunk.uniform.cellCount = config->infiniteTerrain
+                                      ? glm::uvec2(chunkBladesPerSide)
+                                      : glm::uvec2(glm::min(glm::ivec2(chunkBladesPerSide),
+                                                            glm::ivec2(bladesPerSide) - chunk.uniform.cellOffset));
+        chunk.uniform.firstBlade = chunkIndex * chunkBladesPerSide * chunkBladesPerSide;
+        chunk.uniform.bladesPerSide = chunkBladesPerSide;
+        chunk.uniformOffset = static_cast<uint32_t>(chunkIndex * chunkStride);
+        ctx->getQueue().WriteBuffer(chunkUniformBuffer, chunk.uniformOffset, &chunk.uniform, sizeof(ChunkUniformData));
+    }
+
+
+    void ComputeManager::updateChunkBounds(const std::vector<uint32_t>& chunkIndices)
+    {
+        const GrassGenUniformData& gen = config->grassUniform;
+        // Blades bend in any direction but never reach further than their height
+        const float maxBladeHeight = gen.bladeHeight + gen.sizeNoiseAmplitude + CHUNK_BOUNDS_MARGIN;
+        const float horizontalMargin = 0.5f * gen.maxNoisePositionOffset + maxBladeHeight;
 
-        return sharedLayout != nullptr && sharedBindGroup != nullptr;;
+        for (const uint32_t chunkIndex : chunkIndices)
+        {
+            GrassChunk& chunk = chunks[chunkIndex];
+            const glm::vec2 firstCell = glm::vec2(chunk.uniform.cellOffset) / gen.density - gen.sideLength;
+            const glm::vec2 lastCell = (glm::vec2(chunk.uniform.cellOffset) + glm::vec2(chunk.uniform.cellCount - 1u)) /
+                gen.density - gen.sideLength;
+            chunk.boundsMin = {
+                firstCell.x - horizontalMargin, terrainHeightRange.x - maxBladeHeight, firstCell.y - horizontalMargin
+            };
+            chunk.boundsMax = {
+                lastCell.x + horizontalMargin, terrainHeightRange.y + maxBladeHeight, lastCell.y + horizontalMargin
+            };
+        }
     }
 
 
@@ -96,7 +367,7 @@ namespace grass
         wgpu::BufferDescriptor movDynamicBufferDesc = {
             .label = "Mov dynamic uniform buffer",
             .usage = wgpu::BufferUsage::Uniform | wgpu::BufferUsage::CopyDst,
-            .size = sizeof(float),
+            .size = sizeof(MovFrameUniformData),
             .mappedAtCreation = false
         };
         movDynamicUniformBuffer = ctx->getDevice().CreateBuffer(&movDynamicBufferDesc);
@@ -105,196 +376,1307 @@ namespace grass
     }
 
 
-    bool ComputeManager::initGenPipeline()
+    bool ComputeManager::createWindField(StartupScheduler& scheduler)
     {
-        const wgpu::ShaderModule genModule = getShaderModule(ctx->getDevice(), "../shaders/gen.compute.wgsl",
-                                                             "Grass generation compute module");
-        wgpu::ComputePipelineDescriptor genPipelineDesc;
-        genPipelineDesc.label = "Generation compute pipeline";
+        // rgba16float is the smallest format both writable from compute and filterable
+        wgpu::TextureDescriptor windFieldTextureDesc = {
+            .label = "Wind field texture",
+            .usage = wgpu::TextureUsage::TextureBinding | wgpu::TextureUsage::StorageBinding,
+            .dimension = wgpu::TextureDimension::e2D,
+            .size = {config->windFieldResolution, config->windFieldResolution, 1},
+            .format = wgpu::TextureFormat::RGBA16Float,
+            .mipLevelCount = 1,
+            .sampleCount = 1,
+        };
+        windFieldTexture = ctx->getDevice().CreateTexture(&windFieldTextureDesc);
+        if (windFieldTexture == nullptr) return false;
+        windFieldView = windFieldTexture.CreateView();
 
-        wgpu::ProgrammableStageDescriptor genStageDesc = {
-            .module = genModule,
-            .entryPoint = "main"
+        wgpu::SamplerDescriptor windFieldSamplerDesc = {
+            .label = "Wind field sampler",
+            .magFilter = wgpu::FilterMode::Linear,
+            .minFilter = wgpu::FilterMode::Linear,
         };
-        genPipelineDesc.compute = genStageDesc;
+        windFieldSampler = ctx->getObjectCache().getSampler(windFieldSamplerDesc);
 
+        ShaderManager& shaderManager = ctx->getShaderManager();
+        const wgpu::ShaderModule windModule = shaderManager.getModule("../shaders/wind.compute.wgsl",
+                                                                      "Wind field compute module");
+        wgpu::ComputePipelineDescriptor windPipelineDesc;
+        windPipelineDesc.label = "Wind field compute pipeline";
+        windPipelineDesc.compute = {
+            .module = windModule,
+            .entryPoint = "main",
+        };
 
-        wgpu::BindGroupLayoutEntry genEntryLayout = {
-            .binding = 0,
-            .visibility = wgpu::ShaderStage::Compute,
-            .buffer = {
-                .type = wgpu::BufferBindingType::Uniform,
-                .minBindingSize = sizeof(config->grassUniform)
+        wgpu::BindGroupLayoutEntry windEntryLayouts[3] = {
+            {
+                .binding = 0,
+                .visibility = wgpu::ShaderStage::Compute,
+                .buffer = {
+                    .type = wgpu::BufferBindingType::Uniform,
+                    .minBindingSize = sizeof(config->movUniform)
+                }
+            },
+            {
+                .binding = 1,
+                .visibility = wgpu::ShaderStage::Compute,
+                .buffer = {
+                    .type = wgpu::BufferBindingType::Uniform,
+                    .minBindingSize = sizeof(MovFrameUniformData)
+                }
+            },
+            {
+                .binding = 2,
+                .visibility = wgpu::ShaderStage::Compute,
+                .storageTexture = {
+                    .access = wgpu::StorageTextureAccess::WriteOnly,
+                    .format = wgpu::TextureFormat::RGBA16Float,
+                    .viewDimension = wgpu::TextureViewDimension::e2D
+                }
             }
         };
-        wgpu::BindGroupLayoutDescriptor genBindGroupLayoutDesc = {
-            .entryCount = 1,
-            .entries = &genEntryLayout
-        };
-        wgpu::BindGroupLayout genBindGroupLayout = ctx->getDevice().CreateBindGroupLayout(&genBindGroupLayoutDesc);
-
-        wgpu::BindGroupLayout bindGroupLayouts[2] = {
-            sharedLayout, genBindGroupLayout
+        wgpu::BindGroupLayoutDescriptor windBindGroupLayoutDesc = {
+            .entryCount = 3,
+            .entries = &windEntryLayouts[0]
         };
+        wgpu::BindGroupLayout windBindGroupLayout = ctx->getObjectCache().getBindGroupLayout(windBindGroupLayoutDesc);
 
-        wgpu::PipelineLayoutDescriptor genPipelineLayoutDesc = {
-            .label = "Generation pipeline layout",
-            .bindGroupLayoutCount = 2,
-            .bindGroupLayouts = &bindGroupLayouts[0]
+        wgpu::PipelineLayoutDescriptor windPipelineLayoutDesc = {
+            .label = "Wind field pipeline layout",
+            .bindGroupLayoutCount = 1,
+            .bindGroupLayouts = &windBindGroupLayout
         };
-        genPipelineDesc.layout = ctx->getDevice().CreatePipelineLayout(&genPipelineLayoutDesc);
+        windPipelineDesc.layout = ctx->getObjectCache().getPipelineLayout(windPipelineLayoutDesc);
 
-        genPipeline = ctx->getDevice().CreateComputePipeline(&genPipelineDesc);
+        scheduler.createPipeline(windPipelineDesc, windPipeline);
 
-
-        wgpu::BindGroupEntry genEntry =
-        {
-            .binding = 0,
-            .buffer = genSettingsUniformBuffer,
-            .offset = 0,
-            .size = genSettingsUniformBuffer.GetSize(),
+        wgpu::BindGroupEntry windEntries[3] = {
+            {
+                .binding = 0,
+                .buffer = movSettingsUniformBuffer,
+                .offset = 0,
+                .size = movSettingsUniformBuffer.GetSize(),
+            },
+            {
+                .binding = 1,
+                .buffer = movDynamicUniformBuffer,
+                .offset = 0,
+                .size = movDynamicUniformBuffer.GetSize(),
+            },
+            {
+                .binding = 2,
+                .textureView = windFieldView,
+            },
         };
 
         wgpu::BindGroupDescriptor bindGroupDesc = {
-            .label = "Generation uniform bind group",
-            .layout = genBindGroupLayout,
-            .entryCount = 1,
-            .entries = &genEntry
+            .label = "Wind field bind group",
+            .layout = windBindGroupLayout,
+            .entryCount = 3,
+            .entries = &windEntries[0]
         };
-        genBindGroup = ctx->getDevice().CreateBindGroup(&bindGroupDesc);
+        windBindGroup = ctx->getDevice().CreateBindGroup(&bindGroupDesc);
 
-        return genPipeline != nullptr && genBindGroup != nullptr;
+        return windFieldSampler != nullptr && windBindGroup != nullptr;
     }
 
 
-    bool ComputeManager::initMovPipeline()
+    bool ComputeManager::createColliderBuffers(StartupScheduler& scheduler)
     {
-        const wgpu::ShaderModule movModule = getShaderModule(ctx->getDevice(), "../shaders/move.compute.wgsl",
-                                                             "Grass movement compute module");
-        wgpu::ComputePipelineDescriptor movPipelineDesc;
-        movPipelineDesc.label = "Movement compute pipeline";
+        const uint32_t cellCount = config->colliderGridCellsPerSide * config->colliderGridCellsPerSide;
+        wgpu::BufferDescriptor colliderGridBufferDesc = {
+            .label = "Collider grid uniform buffer",
+            .usage = wgpu::BufferUsage::Uniform | wgpu::BufferUsage::CopyDst,
+            .size = sizeof(ColliderGridUniformData),
+            .mappedAtCreation = false
+        };
+        colliderGridUniformBuffer = ctx->getDevice().CreateBuffer(&colliderGridBufferDesc);
+        // No collider until the first update
+        const ColliderGridUniformData emptyGrid = {
+            .cellsPerSide = config->colliderGridCellsPerSide,
+            .maxCellColliders = config->maxCellColliders,
+        };
+        ctx->getQueue().WriteBuffer(colliderGridUniformBuffer, 0, &emptyGrid, sizeof(emptyGrid));
 
-        wgpu::ProgrammableStageDescriptor movStageDesc = {
-            .module = movModule,
-            .entryPoint = "main"
+        wgpu::BufferDescriptor colliderBufferDesc = {
+            .label = "Collider storage buffer",
+            .usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst,
+            .size = sizeof(ColliderData) * config->maxColliders,
+            .mappedAtCreation = false
         };
-        movPipelineDesc.compute = movStageDesc;
+        colliderBuffer = ctx->getDevice().CreateBuffer(&colliderBufferDesc);
+
+        // Counts are cleared before each binning pass
+        wgpu::BufferDescriptor colliderCellCountBufferDesc = {
+            .label = "Collider cell count storage buffer",
+            .usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst,
+            .size = sizeof(uint32_t) * cellCount,
+            .mappedAtCreation = false
+        };
+        colliderCellCountBuffer = ctx->getDevice().CreateBuffer(&colliderCellCountBufferDesc);
 
+        wgpu::BufferDescriptor colliderCellBufferDesc = {
+            .label = "Collider cell storage buffer",
+            .usage = wgpu::BufferUsage::Storage,
+            .size = sizeof(uint32_t) * cellCount * config->maxCellColliders,
+            .mappedAtCreation = false
+        };
+        colliderCellBuffer = ctx->getDevice().CreateBuffer(&colliderCellBufferDesc);
+        if (!colliderGridUniformBuffer || !colliderBuffer || !colliderCellCountBuffer || !colliderCellBuffer)
+            return false;
+
+        ShaderManager& shaderManager = ctx->getShaderManager();
+        const wgpu::ShaderModule binModule = shaderManager.getModule("../shaders/collider_bin.compute.wgsl",
+                                                                     "Collider binning compute module");
+        wgpu::ComputePipelineDescriptor binPipelineDesc;
+        binPipelineDesc.label = "Collider binning compute pipeline";
+        binPipelineDesc.compute = {
+            .module = binModule,
+            .entryPoint = "main",
+        };
 
-        wgpu::BindGroupLayoutEntry movEntryLayouts[2] = {
+        wgpu::BindGroupLayoutEntry binEntryLayouts[4] = {
             {
                 .binding = 0,
                 .visibility = wgpu::ShaderStage::Compute,
                 .buffer = {
                     .type = wgpu::BufferBindingType::Uniform,
-                    .minBindingSize = sizeof(config->movUniform)
+                    .minBindingSize = sizeof(ColliderGridUniformData)
                 }
             },
             {
                 .binding = 1,
                 .visibility = wgpu::ShaderStage::Compute,
                 .buffer = {
-                    .type = wgpu::BufferBindingType::Uniform,
-                    .minBindingSize = sizeof(float)
+                    .type = wgpu::BufferBindingType::ReadOnlyStorage,
+                }
+            },
+            {
+                .binding = 2,
+                .visibility = wgpu::ShaderStage::Compute,
+                .buffer = {
+                    .type = wgpu::BufferBindingType::Storage,
+                }
+            },
+            {
+                .binding = 3,
+                .visibility = wgpu::ShaderStage::Compute,
+                .buffer = {
+                    .type = wgpu::BufferBindingType::Storage,
                 }
             }
         };
-        wgpu::BindGroupLayoutDescriptor movBindGroupLayoutDesc = {
-            .entryCount = 2,
-            .entries = &movEntryLayouts[0]
-        };
-        wgpu::BindGroupLayout movBindGroupLayout = ctx->getDevice().CreateBindGroupLayout(&movBindGroupLayoutDesc);
-
-        wgpu::BindGroupLayout bindGroupLayouts[2] = {
-            sharedLayout, movBindGroupLayout
+        wgpu::BindGroupLayoutDescriptor binBindGroupLayoutDesc = {
+            .entryCount = 4,
+            .entries = &binEntryLayouts[0]
         };
+        wgpu::BindGroupLayout binBindGroupLayout = ctx->getObjectCache().getBindGroupLayout(binBindGroupLayoutDesc);
 
-        wgpu::PipelineLayoutDescriptor movPipelineLayoutDesc = {
-            .label = "Movement pipeline layout",
-            .bindGroupLayoutCount = 2,
-            .bindGroupLayouts = &bindGroupLayouts[0]
+        wgpu::PipelineLayoutDescriptor binPipelineLayoutDesc = {
+            .label = "Collider binning pipeline layout",
+            .bindGroupLayoutCount = 1,
+            .bindGroupLayouts = &binBindGroupLayout
         };
-        movPipelineDesc.layout = ctx->getDevice().CreatePipelineLayout(&movPipelineLayoutDesc);
+        binPipelineDesc.layout = ctx->getObjectCache().getPipelineLayout(binPipelineLayoutDesc);
 
-        movPipeline = ctx->getDevice().CreateComputePipeline(&movPipelineDesc);
+        scheduler.createPipeline(binPipelineDesc, colliderBinPipeline);
 
-        wgpu::BindGroupEntry movEntries[2] = {
+        wgpu::BindGroupEntry binEntries[4] = {
             {
                 .binding = 0,
-                .buffer = movSettingsUniformBuffer,
+                .buffer = colliderGridUniformBuffer,
                 .offset = 0,
-                .size = movSettingsUniformBuffer.GetSize(),
+                .size = colliderGridUniformBuffer.GetSize(),
             },
             {
                 .binding = 1,
-                .buffer = movDynamicUniformBuffer,
+                .buffer = colliderBuffer,
                 .offset = 0,
-                .size = movDynamicUniformBuffer.GetSize(),
+                .size = colliderBuffer.GetSize(),
+            },
+            {
+                .binding = 2,
+                .buffer = colliderCellCountBuffer,
+                .offset = 0,
+                .size = colliderCellCountBuffer.GetSize(),
+            },
+            {
+                .binding = 3,
+                .buffer = colliderCellBuffer,
+                .offset = 0,
+                .size = colliderCellBuffer.GetSize(),
             },
         };
 
         wgpu::BindGroupDescriptor bindGroupDesc = {
-            .label = "Movement uniform bind group",
-            .layout = movBindGroupLayout,
-            .entryCount = 2,
-            .entries = &movEntries[0]
+            .label = "Collider binning bind group",
+            .layout = binBindGroupLayout,
+            .entryCount = 4,
+            .entries = &binEntries[0]
         };
-        movBindGroup = ctx->getDevice().CreateBindGroup(&bindGroupDesc);
+        colliderBinBindGroup = ctx->getDevice().CreateBindGroup(&bindGroupDesc);
 
-        return movPipeline != nullptr && movBindGroup != nullptr;
-    }
-
-
-    void ComputeManager::updateMovSettingsUniorm()
-    {
-        ctx->getQueue().WriteBuffer(movSettingsUniformBuffer, 0, &config->movUniform,
-                                    movSettingsUniformBuffer.GetSize());
+        return colliderBinBindGroup != nullptr;
     }
 
 
-    void ComputeManager::generate()
+    bool ComputeManager::createTrampleMap()
     {
-        ctx->getQueue().WriteBuffer(genSettingsUniformBuffer, 0, &config->grassUniform,
-                                    genSettingsUniformBuffer.GetSize());
-        wgpu::CommandEncoderDescriptor encoderDesc;
-        wgpu::CommandEncoder encoder = ctx->getDevice().CreateCommandEncoder(&encoderDesc);
-
-        wgpu::ComputePassDescriptor computePassDesc;
-        wgpu::ComputePassEncoder pass = encoder.BeginComputePass(&computePassDesc);
-
-        pass.SetPipeline(genPipeline);
-        pass.SetBindGroup(0, sharedBindGroup);
-        pass.SetBindGroup(1, genBindGroup);
-        pass.DispatchWorkgroups(config->bladesPerSide, config->bladesPerSide, 1);
-        pass.End();
+        wgpu::BufferDescriptor trampleUniformBufferDesc = {
+            .label = "Trample uniform buffer",
+            .usage = wgpu::BufferUsage::Uniform | wgpu::BufferUsage::CopyDst,
+            .size = sizeof(TrampleUniformData),
+            .mappedAtCreation = false
+        };
+        trampleUniformBuffer = ctx->getDevice().CreateBuffer(&trampleUniformBufferDesc);
 
-        wgpu::CommandBufferDescriptor cmdBufferDescriptor = {
-            .label = "Generation operations command buffer"
+        // Same format as the wind field, read back by the next stamp
+        wgpu::TextureDescriptor trampleTextureDesc = {
+            .label = "Trample map texture",
+            .usage = wgpu::TextureUsage::TextureBinding | wgpu::TextureUsage::StorageBinding,
+            .dimension = wgpu::TextureDimension::e2D,
+            .size = {config->trampleResolution, config->trampleResolution, 1},
+            .format = wgpu::TextureFormat::RGBA16Float,
+            .mipLevelCount = 1,
+            .sampleCount = 1,
         };
-        wgpu::CommandBuffer command = encoder.Finish(&cmdBufferDescriptor);
-        ctx->getQueue().Submit(1, &command);
+        for (size_t i = 0; i < trampleTextures.size(); i++)
+        {
+            trampleTextures[i] = ctx->getDevice().CreateTexture(&trampleTextureDesc);
+            if (trampleTextures[i] == nullptr) return false;
+            trampleViews[i] = trampleTextures[i].CreateView();
+        }
+
+        return trampleUniformBuffer != nullptr;
     }
 
 
-    void ComputeManager::computeMovement(float time)
+    bool ComputeManager::initTramplePipeline(StartupScheduler& scheduler)
     {
-        ctx->getQueue().WriteBuffer(movDynamicUniformBuffer, 0, &time, movDynamicUniformBuffer.GetSize());
-        wgpu::CommandEncoderDescriptor encoderDesc;
-        wgpu::CommandEncoder encoder = ctx->getDevice().CreateCommandEncoder(&encoderDesc);
-
-        wgpu::ComputePassDescriptor computePassDesc;
-        wgpu::ComputePassEncoder pass = encoder.BeginComputePass(&computePassDesc);
-
-        pass.SetPipeline(movPipeline);
-        pass.SetBindGroup(0, sharedBindGroup);
-        pass.SetBindGroup(1, movBindGroup);
-        pass.DispatchWorkgroups(config->bladesPerSide, config->bladesPerSide, 1);
-        pass.End();
+        ShaderManager& shaderManager = ctx->getShaderManager();
+        const wgpu::ShaderModule trampleModule = shaderManager.getModule("../shaders/trample.compute.wgsl",
+                                                                         "Trample compute module");
+        wgpu::ComputePipelineDescriptor tramplePipelineDesc;
+        tramplePipelineDesc.label = "Trample compute pipeline";
+        tramplePipelineDesc.compute = {
+            .module = trampleModule,
+            .entryPoint = "main",
+        };
 
-        wgpu::CommandBufferDescriptor cmdBufferDescriptor = {
-            .label = "Movement operations command buffer"
+        wgpu::BindGroupLayoutEntry mapEntryLayouts[3] = {
+            {
+                .binding = 0,
+                .visibility = wgpu::ShaderStage::Compute,
+                .buffer = {
+                    .type = wgpu::BufferBindingType::Uniform,
+                    .minBindingSize = sizeof(TrampleUniformData)
+                }
+            },
+            {
+                .binding = 1,
+                .visibility = wgpu::ShaderStage::Compute,
+                .texture = {
+                    .sampleType = wgpu::TextureSampleType::Float,
+                    .viewDimension = wgpu::TextureViewDimension::e2D
+                }
+            },
+            {
+                .binding = 2,
+                .visibility = wgpu::ShaderStage::Compute,
+                .storageTexture = {
+                    .access = wgpu::StorageTextureAccess::WriteOnly,
+                    .format = wgpu::TextureFormat::RGBA16Float,
+                    .viewDimension = wgpu::TextureViewDimension::e2D
+                }
+            }
+        };
+        wgpu::BindGroupLayoutDescriptor mapBindGroupLayoutDesc = {
+            .entryCount = 3,
+            .entries = &mapEntryLayouts[0]
         };
-        wgpu::CommandBuffer command = encoder.Finish(&cmdBufferDescriptor);
-        ctx->getQueue().Submit(1, &command);
+        wgpu::BindGroupLayout mapBindGroupLayout = ctx->getObjectCache().getBindGroupLayout(mapBindGroupLayoutDesc);
+
+        wgpu::BindGroupLayoutEntry colliderEntryLayouts[4] = {
+            {
+                .binding = 0,
+                .visibility = wgpu::ShaderStage::Compute,
+                .buffer = {
+                    .type = wgpu::BufferBindingType::Uniform,
+                    .minBindingSize = sizeof(ColliderGridUniformData)
+                }
+            },
+            {
+                .binding = 1,
+                .visibility = wgpu::ShaderStage::Compute,
+                .buffer = {
+                    .type = wgpu::BufferBindingType::ReadOnlyStorage,
+                }
+            },
+            {
+                .binding = 2,
+                .visibility = wgpu::ShaderStage::Compute,
+                .buffer = {
+                    .type = wgpu::BufferBindingType::ReadOnlyStorage,
+                }
+            },
+            {
+                .binding = 3,
+                .visibility = wgpu::ShaderStage::Compute,
+                .buffer = {
+                    .type = wgpu::BufferBindingType::ReadOnlyStorage,
+                }
+            },
+        };
+        wgpu::BindGroupLayoutDescriptor colliderBindGroupLayoutDesc = {
+            .entryCount = 4,
+            .entries = &colliderEntryLayouts[0]
+        };
+        wgpu::BindGroupLayout colliderBindGroupLayout = ctx->getObjectCache().getBindGroupLayout(
+            colliderBindGroupLayoutDesc);
+
+        wgpu::BindGroupLayout bindGroupLayouts[3] = {
+            mapBindGroupLayout, terrainSampleBindGroupLayout, colliderBindGroupLayout
+        };
+        wgpu::PipelineLayoutDescriptor tramplePipelineLayoutDesc = {
+            .label = "Trample pipeline layout",
+            .bindGroupLayoutCount = 3,
+            .bindGroupLayouts = &bindGroupLayouts[0]
+        };
+        tramplePipelineDesc.layout = ctx->getObjectCache().getPipelineLayout(tramplePipelineLayoutDesc);
+        scheduler.createPipeline(tramplePipelineDesc, tramplePipeline);
+
+        // Each bind group stamps one texture from the other
+        for (size_t i = 0; i < trampleBindGroups.size(); i++)
+        {
+            wgpu::BindGroupEntry mapEntries[3] = {
+                {
+                    .binding = 0,
+                    .buffer = trampleUniformBuffer,
+                    .offset = 0,
+                    .size = trampleUniformBuffer.GetSize(),
+                },
+                {
+                    .binding = 1,
+                    .textureView = trampleViews[1 - i],
+                },
+                {
+                    .binding = 2,
+                    .textureView = trampleViews[i],
+                },
+            };
+            wgpu::BindGroupDescriptor mapBindGroupDesc = {
+                .label = "Trample map bind group",
+                .layout = mapBindGroupLayout,
+                .entryCount = 3,
+                .entries = &mapEntries[0]
+            };
+            trampleBindGroups[i] = ctx->getDevice().CreateBindGroup(&mapBindGroupDesc);
+            if (trampleBindGroups[i] == nullptr) return false;
+        }
+
+        wgpu::BindGroupEntry colliderEntries[4] = {
+            {
+                .binding = 0,
+                .buffer = colliderGridUniformBuffer,
+                .offset = 0,
+                .size = colliderGridUniformBuffer.GetSize(),
+            },
+            {
+                .binding = 1,
+                .buffer = colliderBuffer,
+                .offset = 0,
+                .size = colliderBuffer.GetSize(),
+            },
+            {
+                .binding = 2,
+                .buffer = colliderCellCountBuffer,
+                .offset = 0,
+                .size = colliderCellCountBuffer.GetSize(),
+            },
+            {
+                .binding = 3,
+                .buffer = colliderCellBuffer,
+                .offset = 0,
+                .size = colliderCellBuffer.GetSize(),
+            },
+        };
+        wgpu::BindGroupDescriptor colliderBindGroupDesc = {
+            .label = "Trample colliders bind group",
+            .layout = colliderBindGroupLayout,
+            .entryCount = 4,
+            .entries = &colliderEntries[0]
+        };
+        trampleColliderBindGroup = ctx->getDevice().CreateBindGroup(&colliderBindGroupDesc);
+
+        return trampleColliderBindGroup != nullptr;
+    }
+
+
+    bool ComputeManager::createTerrain(StartupScheduler& scheduler, std::future<ImageData>& heightmapImage)
+    {
+        const bool bakeTerrain = config->terrainHeightmapPath.empty();
+        config->grassUniform.terrainHeightScale = bakeTerrain ? 1.0f : config->terrainHeightmapScale;
+        ctx->getQueue().WriteBuffer(genSettingsUniformBuffer, 0, &config->grassUniform,
+                                    genSettingsUniformBuffer.GetSize());
+
+        if (bakeTerrain)
+        {
+            terrainHeightRange = {-BAKED_TERRAIN_HEIGHT_RANGE, BAKED_TERRAIN_HEIGHT_RANGE};
+            wgpu::TextureDescriptor terrainHeightmapDesc = {
+                .label = "Terrain heightmap texture",
+                .usage = wgpu::TextureUsage::TextureBinding | wgpu::TextureUsage::StorageBinding,
+                .dimension = wgpu::TextureDimension::e2D,
+                .size = {config->terrainResolution, config->terrainResolution, 1},
+                .format = wgpu::TextureFormat::RGBA16Float,
+                .mipLevelCount = 1,
+                .sampleCount = 1,
+            };
+            terrainHeightmap = ctx->getDevice().CreateTexture(&terrainHeightmapDesc);
+        }
+        else
+        {
+            terrainHeightRange = {0.0f, config->terrainHeightmapScale};
+            const ImageData image = heightmapImage.get();
+            // Infinite terrain repeats the heightmap, a seam would be a cliff every field length
+            if (config->infiniteTerrain && !image.pixels.empty() && !isHeightmapTileable(image))
+            {
+                std::cerr << "Terrain heightmap " << config->terrainHeightmapPath
+                    << " does not tile, infinite terrain needs a tileable heightmap" << std::endl;
+                return false;
+            }
+            terrainHeightmap = createTexture(image);
+            if (terrainHeightmap == nullptr)
+            {
+                std::cerr << "Could not load terrain heightmap " << config->terrainHeightmapPath << std::endl;
+            }
+        }
+        if (terrainHeightmap == nullptr) return false;
+        terrainHeightmapView = terrainHeightmap.CreateView();
+
+        // Infinite terrain tiles the heightmap
+        const wgpu::AddressMode addressMode = config->infiniteTerrain
+                                                  ? wgpu::AddressMode::Repeat
+                                                  : wgpu::AddressMode::ClampToEdge;
+        wgpu::SamplerDescriptor terrainSamplerDesc = {
+            .label = "Terrain sampler",
+            .addressModeU = addressMode,
+            .addressModeV = addressMode,
+            .magFilter = wgpu::FilterMode::Linear,
+            .minFilter = wgpu::FilterMode::Linear,
+        };
+        terrainSampler = ctx->getObjectCache().getSampler(terrainSamplerDesc);
+
+        if (!bakeTerrain) return terrainSampler != nullptr;
+
+        // The procedural terrain is evaluated once, generation only samples it
+        ShaderManager& shaderManager = ctx->getShaderManager();
+        const wgpu::ShaderModule terrainModule = shaderManager.getModule("../shaders/terrain.compute.wgsl",
+                                                                         "Terrain compute module");
+        wgpu::ComputePipelineDescriptor terrainPipelineDesc;
+        terrainPipelineDesc.label = "Terrain compute pipeline";
+        // Infinite terrain repeats the baked heightmap, it is then made periodic
+        const wgpu::ConstantEntry terrainConstant = {
+            .key = "TILEABLE",
+            .value = config->infiniteTerrain ? 1.0 : 0.0
+        };
+        terrainPipelineDesc.compute = {
+            .module = terrainModule,
+            .entryPoint = "main",
+            .constantCount = 1,
+            .constants = &terrainConstant
+        };
+
+        wgpu::BindGroupLayoutEntry terrainEntryLayouts[2] = {
+            {
+                .binding = 0,
+                .visibility = wgpu::ShaderStage::Compute,
+                .buffer = {
+                    .type = wgpu::BufferBindingType::Uniform,
+                    .minBindingSize = sizeof(config->grassUniform)
+                }
+            },
+            {
+                .binding = 1,
+                .visibility = wgpu::ShaderStage::Compute,
+                .storageTexture = {
+                    .access = wgpu::StorageTextureAccess::WriteOnly,
+                    .format = wgpu::TextureFormat::RGBA16Float,
+                    .viewDimension = wgpu::TextureViewDimension::e2D
+                }
+            }
+        };
+        wgpu::BindGroupLayoutDescriptor terrainBindGroupLayoutDesc = {
+            .entryCount = 2,
+            .entries = &terrainEntryLayouts[0]
+        };
+        wgpu::BindGroupLayout terrainBindGroupLayout = ctx->getObjectCache().getBindGroupLayout(
+            terrainBindGroupLayoutDesc);
+
+        wgpu::PipelineLayoutDescriptor terrainPipelineLayoutDesc = {
+            .label = "Terrain pipeline layout",
+            .bindGroupLayoutCount = 1,
+            .bindGroupLayouts = &terrainBindGroupLayout
+        };
+        terrainPipelineDesc.layout = ctx->getObjectCache().getPipelineLayout(terrainPipelineLayoutDesc);
+        scheduler.createPipeline(terrainPipelineDesc, terrainPipeline);
+
+        wgpu::BindGroupEntry terrainEntries[2] = {
+            {
+                .binding = 0,
+                .buffer = genSettingsUniformBuffer,
+                .offset = 0,
+                .size = genSettingsUniformBuffer.GetSize(),
+            },
+            {
+                .binding = 1,
+                .textureView = terrainHeightmapView,
+            },
+        };
+        wgpu::BindGroupDescriptor terrainBindGroupDesc = {
+            .label = "Terrain bind group",
+            .layout = terrainBindGroupLayout,
+            .entryCount = 2,
+            .entries = &terrainEntries[0]
+        };
+        terrainBindGroup = ctx->getDevice().CreateBindGroup(&terrainBindGroupDesc);
+        terrainBakePending = true;
+
+        return terrainSampler != nullptr && terrainBindGroup != nullptr;
+    }
+
+
+    bool ComputeManager::createTerrainSampleBindGroup()
+    {
+        wgpu::BindGroupLayoutEntry terrainSampleEntryLayouts[3] = {
+            {
+                .binding = 0,
+                .visibility = wgpu::ShaderStage::Compute,
+                .buffer = {
+                    .type = wgpu::BufferBindingType::Uniform,
+                    .minBindingSize = sizeof(config->grassUniform)
+                }
+            },
+            {
+                .binding = 1,
+                .visibility = wgpu::ShaderStage::Compute,
+                .texture = {
+                    .sampleType = wgpu::TextureSampleType::Float,
+                    .viewDimension = wgpu::TextureViewDimension::e2D
+                }
+            },
+            {
+                .binding = 2,
+                .visibility = wgpu::ShaderStage::Compute,
+                .sampler = {
+                    .type = wgpu::SamplerBindingType::Filtering,
+                }
+            }
+        };
+        wgpu::BindGroupLayoutDescriptor terrainSampleBindGroupLayoutDesc = {
+            .entryCount = 3,
+            .entries = &terrainSampleEntryLayouts[0]
+        };
+        terrainSampleBindGroupLayout = ctx->getObjectCache().getBindGroupLayout(terrainSampleBindGroupLayoutDesc);
+
+        wgpu::BindGroupEntry terrainSampleEntries[3] = {
+            {
+                .binding = 0,
+                .buffer = genSettingsUniformBuffer,
+                .offset = 0,
+                .size = genSettingsUniformBuffer.GetSize(),
+            },
+            {
+                .binding = 1,
+                .textureView = terrainHeightmapView,
+            },
+            {
+                .binding = 2,
+                .sampler = terrainSampler,
+            },
+        };
+        wgpu::BindGroupDescriptor terrainSampleBindGroupDesc = {
+            .label = "Terrain sample bind group",
+            .layout = terrainSampleBindGroupLayout,
+            .entryCount = 3,
+            .entries = &terrainSampleEntries[0]
+        };
+        terrainSampleBindGroup = ctx->getDevice().CreateBindGroup(&terrainSampleBindGroupDesc);
+
+        return terrainSampleBindGroup != nullptr;
+    }
+
+
+    bool ComputeManager::createCullBuffers()
+    {
+        wgpu::BufferDescriptor cullUniformBufferDesc = {
+            .label = "Cull uniform buffer",
+            .usage = wgpu::BufferUsage::Uniform | wgpu::BufferUsage::CopyDst,
+            .size = sizeof(config->cullUniform),
+            .mappedAtCreation = false
+        };
+        cullUniformBuffer = ctx->getDevice().CreateBuffer(&cullUniformBufferDesc);
+
+        // Every LOD list can hold every blade of the chunk ranges, and is bound with a dynamic offset by the Renderer.
+        // Streamed chunks are always full, so more blades than the fixed field can be visible.
+        const uint64_t alignment = ctx->getLimits().minStorageBufferOffsetAlignment;
+        lodStride = (sizeof(uint32_t) * config->bladeCapacity + alignment - 1) / alignment * alignment;
+        config->cullUniform.lodStride = static_cast<uint32_t>(lodStride / sizeof(uint32_t));
+        config->cullUniform.lodCount = BLADE_LOD_COUNT;
+
+        wgpu::BufferDescriptor visibleBladesBufferDesc = {
+            .label = "Visible blade indices storage buffer",
+            .usage = wgpu::BufferUsage::Storage,
+            .size = lodStride * BLADE_LOD_COUNT,
+            .mappedAtCreation = false
+        };
+        visibleBladesBuffer = ctx->getDevice().CreateBuffer(&visibleBladesBufferDesc);
+
+        // indexCount is written once by the Renderer, instanceCount is reset before each culling pass
+        wgpu::BufferDescriptor drawArgsBufferDesc = {
+            .label = "Grass draw indirect buffer",
+            .usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::Indirect | wgpu::BufferUsage::CopyDst,
+            .size = sizeof(DrawIndexedIndirectArgs) * BLADE_LOD_COUNT,
+            .mappedAtCreation = false
+        };
+        drawArgsBuffer = ctx->getDevice().CreateBuffer(&drawArgsBufferDesc);
+
+        return cullUniformBuffer != nullptr && visibleBladesBuffer != nullptr && drawArgsBuffer != nullptr;
+    }
+
+
+    bool ComputeManager::initGenPipeline(StartupScheduler& scheduler)
+    {
+        ShaderManager& shaderManager = ctx->getShaderManager();
+        const wgpu::ShaderModule genModule = shaderManager.getModule("../shaders/gen.compute.wgsl",
+                                                                     "Grass generation compute module",
+                                                                     {getBladeLayoutPath(config->packedBlades)});
+        wgpu::ComputePipelineDescriptor genPipelineDesc;
+        genPipelineDesc.label = "Generation compute pipeline";
+
+        wgpu::ProgrammableStageDescriptor genStageDesc = {
+            .module = genModule,
+            .entryPoint = "main",
+            .constantCount = dispatchConstants.size(),
+            .constants = dispatchConstants.data()
+        };
+        genPipelineDesc.compute = genStageDesc;
+
+
+        wgpu::BindGroupLayout bindGroupLayouts[3] = {
+            genBladeBinding.layout, terrainSampleBindGroupLayout, chunkBindGroupLayout
+        };
+
+        wgpu::PipelineLayoutDescriptor genPipelineLayoutDesc = {
+            .label = "Generation pipeline layout",
+            .bindGroupLayoutCount = 3,
+            .bindGroupLayouts = &bindGroupLayouts[0]
+        };
+        genPipelineDesc.layout = ctx->getObjectCache().getPipelineLayout(genPipelineLayoutDesc);
+
+        scheduler.createPipeline(genPipelineDesc, genPipeline);
+
+        // Same module and layout, only rewrites the height fields of the static stream
+        genPipelineDesc.label = "Height update compute pipeline";
+        genPipelineDesc.compute.entryPoint = "updateHeight";
+        scheduler.createPipeline(genPipelineDesc, heightPipeline);
+
+        return true;
+    }
+
+
+    bool ComputeManager::initMovPipeline(StartupScheduler& scheduler)
+    {
+        ShaderManager& shaderManager = ctx->getShaderManager();
+        const wgpu::ShaderModule movModule = shaderManager.getModule("../shaders/move.compute.wgsl",
+                                                                     "Grass movement compute module",
+                                                                     {getBladeLayoutPath(config->packedBlades)});
+        wgpu::ComputePipelineDescriptor movPipelineDesc;
+        movPipelineDesc.label = "Movement compute pipeline";
+
+        wgpu::ProgrammableStageDescriptor movStageDesc = {
+            .module = movModule,
+            .entryPoint = "main",
+            .constantCount = dispatchConstants.size(),
+            .constants = dispatchConstants.data()
+        };
+        movPipelineDesc.compute = movStageDesc;
+
+
+        wgpu::BindGroupLayoutEntry movEntryLayouts[6] = {
+            {
+                .binding = 0,
+                .visibility = wgpu::ShaderStage::Compute,
+                .buffer = {
+                    .type = wgpu::BufferBindingType::Uniform,
+                    .minBindingSize = sizeof(config->movUniform)
+                }
+            },
+            {
+                .binding = 1,
+                .visibility = wgpu::ShaderStage::Compute,
+                .buffer = {
+                    .type = wgpu::BufferBindingType::Uniform,
+                    .minBindingSize = sizeof(MovFrameUniformData)
+                }
+            },
+            {
+                .binding = 2,
+                .visibility = wgpu::ShaderStage::Compute,
+                .texture = {
+                    .sampleType = wgpu::TextureSampleType::Float,
+                    .viewDimension = wgpu::TextureViewDimension::e2D
+                }
+            },
+            {
+                .binding = 3,
+                .visibility = wgpu::ShaderStage::Compute,
+                .sampler = {
+                    .type = wgpu::SamplerBindingType::Filtering,
+                }
+            },
+            {
+                .binding = 4,
+                .visibility = wgpu::ShaderStage::Compute,
+                .buffer = {
+                    .type = wgpu::BufferBindingType::Uniform,
+                    .minBindingSize = sizeof(TrampleUniformData)
+                }
+            },
+            {
+                .binding = 5,
+                .visibility = wgpu::ShaderStage::Compute,
+                .texture = {
+                    .sampleType = wgpu::TextureSampleType::Float,
+                    .viewDimension = wgpu::TextureViewDimension::e2D
+                }
+            }
+        };
+        wgpu::BindGroupLayoutDescriptor movBindGroupLayoutDesc = {
+            .entryCount = 6,
+            .entries = &movEntryLayouts[0]
+        };
+        wgpu::BindGroupLayout movBindGroupLayout = ctx->getObjectCache().getBindGroupLayout(movBindGroupLayoutDesc);
+
+        wgpu::BindGroupLayout bindGroupLayouts[3] = {
+            movBladeBinding.layout, movBindGroupLayout, chunkBindGroupLayout
+        };
+
+        wgpu::PipelineLayoutDescriptor movPipelineLayoutDesc = {
+            .label = "Movement pipeline layout",
+            .bindGroupLayoutCount = 3,
+            .bindGroupLayouts = &bindGroupLayouts[0]
+        };
+        movPipelineDesc.layout = ctx->getObjectCache().getPipelineLayout(movPipelineLayoutDesc);
+
+        scheduler.createPipeline(movPipelineDesc, movPipeline);
+
+        // One per trample texture, movement reads the one just stamped
+        for (size_t i = 0; i < movBindGroups.size(); i++)
+        {
+            wgpu::BindGroupEntry movEntries[6] = {
+                {
+                    .binding = 0,
+                    .buffer = movSettingsUniformBuffer,
+                    .offset = 0,
+                    .size = movSettingsUniformBuffer.GetSize(),
+                },
+                {
+                    .binding = 1,
+                    .buffer = movDynamicUniformBuffer,
+                    .offset = 0,
+                    .size = movDynamicUniformBuffer.GetSize(),
+                },
+                {
+                    .binding = 2,
+                    .textureView = windFieldView,
+                },
+                {
+                    .binding = 3,
+                    .sampler = windFieldSampler,
+                },
+                {
+                    .binding = 4,
+                    .buffer = trampleUniformBuffer,
+                    .offset = 0,
+                    .size = trampleUniformBuffer.GetSize(),
+                },
+                {
+                    .binding = 5,
+                    .textureView = trampleViews[i],
+                },
+            };
+
+            wgpu::BindGroupDescriptor bindGroupDesc = {
+                .label = "Movement uniform bind group",
+                .layout = movBindGroupLayout,
+                .entryCount = 6,
+                .entries = &movEntries[0]
+            };
+            movBindGroups[i] = ctx->getDevice().CreateBindGroup(&bindGroupDesc);
+            if (movBindGroups[i] == nullptr) return false;
+        }
+
+        return true;
+    }
+
+
+    bool ComputeManager::initCullPipeline(StartupScheduler& scheduler)
+    {
+        ShaderManager& shaderManager = ctx->getShaderManager();
+        const wgpu::ShaderModule cullModule = shaderManager.getModule("../shaders/cull.compute.wgsl",
+                                                                      "Grass culling compute module",
+                                                                      {getBladeLayoutPath(config->packedBlades)});
+        wgpu::ComputePipelineDescriptor cullPipelineDesc;
+        cullPipelineDesc.label = "Culling compute pipeline";
+
+        wgpu::ProgrammableStageDescriptor cullStageDesc = {
+            .module = cullModule,
+            .entryPoint = "main",
+            .constantCount = dispatchConstants.size(),
+            .constants = dispatchConstants.data()
+        };
+        cullPipelineDesc.compute = cullStageDesc;
+
+
+        wgpu::BindGroupLayoutEntry cullEntryLayouts[3] = {
+            {
+                .binding = 0,
+                .visibility = wgpu::ShaderStage::Compute,
+                .buffer = {
+                    .type = wgpu::BufferBindingType::Uniform,
+                    .minBindingSize = sizeof(config->cullUniform)
+                }
+            },
+            {
+                .binding = 1,
+                .visibility = wgpu::ShaderStage::Compute,
+                .buffer = {
+                    .type = wgpu::BufferBindingType::Storage,
+                    .minBindingSize = visibleBladesBuffer.GetSize()
+                }
+            },
+            {
+                .binding = 2,
+                .visibility = wgpu::ShaderStage::Compute,
+                .buffer = {
+                    .type = wgpu::BufferBindingType::Storage,
+                    .minBindingSize = sizeof(DrawIndexedIndirectArgs) * BLADE_LOD_COUNT
+                }
+            }
+        };
+        wgpu::BindGroupLayoutDescriptor cullBindGroupLayoutDesc = {
+            .entryCount = 3,
+            .entries = &cullEntryLayouts[0]
+        };
+        wgpu::BindGroupLayout cullBindGroupLayout = ctx->getObjectCache().getBindGroupLayout(cullBindGroupLayoutDesc);
+
+        wgpu::BindGroupLayout bindGroupLayouts[3] = {
+            cullBladeBinding.layout, cullBindGroupLayout, chunkBindGroupLayout
+        };
+
+        wgpu::PipelineLayoutDescriptor cullPipelineLayoutDesc = {
+            .label = "Culling pipeline layout",
+            .bindGroupLayoutCount = 3,
+            .bindGroupLayouts = &bindGroupLayouts[0]
+        };
+        cullPipelineDesc.layout = ctx->getObjectCache().getPipelineLayout(cullPipelineLayoutDesc);
+
+        scheduler.createPipeline(cullPipelineDesc, cullPipeline);
+
+        wgpu::BindGroupEntry cullEntries[3] = {
+            {
+                .binding = 0,
+                .buffer = cullUniformBuffer,
+                .offset = 0,
+                .size = cullUniformBuffer.GetSize(),
+            },
+            {
+                .binding = 1,
+                .buffer = visibleBladesBuffer,
+                .offset = 0,
+                .size = visibleBladesBuffer.GetSize(),
+            },
+            {
+                .binding = 2,
+                .buffer = drawArgsBuffer,
+                .offset = 0,
+                .size = drawArgsBuffer.GetSize(),
+            },
+        };
+
+        wgpu::BindGroupDescriptor bindGroupDesc = {
+            .label = "Culling bind group",
+            .layout = cullBindGroupLayout,
+            .entryCount = 3,
+            .entries = &cullEntries[0]
+        };
+        cullBindGroup = ctx->getDevice().CreateBindGroup(&bindGroupDesc);
+
+        return cullBindGroup != nullptr;
+    }
+
+
+    void ComputeManager::updateMovSettingsUniorm()
+    {
+        ctx->getQueue().WriteBuffer(movSettingsUniformBuffer, 0, &config->movUniform,
+                                    movSettingsUniformBuffer.GetSize());
+    }
+
+
+    void ComputeManager::generate(FrameGraph& frameGraph)
+    {
+        TRACE_ZONE("ComputeManager::generate");
+        ctx->getQueue().WriteBuffer(genSettingsUniformBuffer, 0, &config->grassUniform,
+                                    genSettingsUniformBuffer.GetSize());
+        if (terrainBakePending)
+        {
+            terrainBakePending = false;
+            frameGraph.addPass(
+                "Terrain bake", FramePassType::Compute, {}, {terrainHeightmap},
+                [this](const wgpu::CommandEncoder& encoder)
+                {
+                    wgpu::ComputePassDescriptor computePassDesc = {
+                        .label = "Terrain bake compute pass",
+                        .timestampWrites = ctx->getProfiler().computePass("Terrain bake")
+                    };
+                    wgpu::ComputePassEncoder pass = encoder.BeginComputePass(&computePassDesc);
+
+                    const uint32_t terrainWorkgroups = (config->terrainResolution + 7) / 8;
+                    pass.SetPipeline(terrainPipeline);
+                    pass.SetBindGroup(0, terrainBindGroup);
+                    pass.DispatchWorkgroups(terrainWorkgroups, terrainWorkgroups, 1);
+                    pass.End();
+                }
+            );
+        }
+        generateChunks(frameGraph, allChunks);
+    }
+
+
+    void ComputeManager::requestHeightUpdate()
+    {
+        heightUpdatePending = true;
+    }
+
+
+    void ComputeManager::updateHeights(FrameGraph& frameGraph)
+    {
+        TRACE_ZONE("ComputeManager::updateHeights");
+        // Coalesce every change of the previous frame into a single uniform upload
+        if (heightUpdatePending)
+        {
+            heightUpdatePending = false;
+            ctx->getQueue().WriteBuffer(genSettingsUniformBuffer, 0, &config->grassUniform,
+                                        genSettingsUniformBuffer.GetSize());
+
+            // Restart from the visible chunks, chunks from a previous sweep are outdated anyway
+            heightUpdateQueue = visibleChunks;
+            for (const uint32_t chunkIndex : allChunks)
+            {
+                if (std::find(visibleChunks.begin(), visibleChunks.end(), chunkIndex) == visibleChunks.end())
+                {
+                    heightUpdateQueue.push_back(chunkIndex);
+                }
+            }
+            heightUpdateCursor = 0;
+        }
+        if (heightUpdateCursor >= heightUpdateQueue.size()) return;
+
+        const size_t remainingChunks = heightUpdateQueue.size() - heightUpdateCursor;
+        const size_t chunkCount = config->heightUpdateChunksPerFrame == 0
+                                      ? remainingChunks
+                                      : std::min<size_t>(config->heightUpdateChunksPerFrame, remainingChunks);
+        const std::vector<uint32_t> chunkIndices(heightUpdateQueue.begin() + heightUpdateCursor,
+                                                 heightUpdateQueue.begin() + heightUpdateCursor + chunkCount);
+        heightUpdateCursor += chunkCount;
+        // Chunks still waiting keep the bounds of their current blades
+        updateChunkBounds(chunkIndices);
+
+        frameGraph.addPass(
+            "Height update", FramePassType::Compute, {staticBladeBuffer}, {staticBladeBuffer},
+            [this, chunkIndices](const wgpu::CommandEncoder& encoder)
+            {
+                wgpu::ComputePassDescriptor computePassDesc = {
+                    .label = "Height update compute pass",
+                    .timestampWrites = ctx->getProfiler().computePass("Height update")
+                };
+                wgpu::ComputePassEncoder pass = encoder.BeginComputePass(&computePassDesc);
+
+                pass.SetPipeline(heightPipeline);
+                pass.SetBindGroup(0, genBladeBinding.bindGroup);
+                pass.SetBindGroup(1, terrainSampleBindGroup);
+                dispatchChunks(pass, chunkIndices);
+                pass.End();
+            }
+        );
+    }
+
+
+    void ComputeManager::generateChunks(FrameGraph& frameGraph, const std::vector<uint32_t>& chunkIndices)
+    {
+        updateChunkBounds(chunkIndices);
+        frameGraph.addPass(
+            "Generation", FramePassType::Compute, {terrainHeightmap}, {staticBladeBuffer, dynamicBladeBuffer},
+            [this, chunkIndices](const wgpu::CommandEncoder& encoder)
+            {
+                wgpu::ComputePassDescriptor computePassDesc = {
+                    .label = "Generation compute pass",
+                    .timestampWrites = ctx->getProfiler().computePass("Generation")
+                };
+                wgpu::ComputePassEncoder pass = encoder.BeginComputePass(&computePassDesc);
+
+                pass.SetPipeline(genPipeline);
+                pass.SetBindGroup(0, genBladeBinding.bindGroup);
+                pass.SetBindGroup(1, terrainSampleBindGroup);
+                dispatchChunks(pass, chunkIndices);
+                pass.End();
+            }
+        );
+    }
+
+
+    void ComputeManager::updateColliders(const std::vector<Mesh>& scene, const Camera& camera)
+    {
+        TRACE_ZONE("ComputeManager::updateColliders");
+        colliders.clear();
+        if (config->cameraColliderRadius > 0.0f)
+        {
+            colliders.push_back({.a = camera.position, .radius = config->cameraColliderRadius, .b = camera.position});
+        }
+        for (const Mesh& mesh : scene)
+        {
+            // Radii follow the largest axis scale of the model
+            const float scale = glm::max(glm::length(glm::vec3(mesh.model[0])),
+                                         glm::max(glm::length(glm::vec3(mesh.model[1])),
+                                                  glm::length(glm::vec3(mesh.model[2]))));
+            for (const MeshCollider& collider : mesh.colliders)
+            {
+                colliders.push_back({
+                    .a = glm::vec3(mesh.model * glm::vec4(collider.a, 1.0f)),
+                    .radius = collider.radius * scale,
+                    .b = glm::vec3(mesh.model * glm::vec4(collider.b, 1.0f)),
+                });
+            }
+        }
+        if (colliders.size() > config->maxColliders) colliders.resize(config->maxColliders);
+
+        // The grid covers the culling distance, blades further away are not drawn
+        const GrassGenUniformData& gen = config->grassUniform;
+        const float gridSize = 2.0f * config->cullUniform.maxDistance;
+        const float cellSize = gridSize / static_cast<float>(config->colliderGridCellsPerSide);
+        const glm::vec2 cameraCell = glm::floor(glm::vec2(camera.position.x, camera.position.z) / cellSize);
+        const ColliderGridUniformData grid = {
+            .origin = cameraCell * cellSize - 0.5f * gridSize,
+            .cellSize = cellSize,
+            .reach = gen.bladeHeight + gen.sizeNoiseAmplitude,
+            .colliderCount = static_cast<uint32_t>(colliders.size()),
+            .cellsPerSide = config->colliderGridCellsPerSide,
+            .maxCellColliders = config->maxCellColliders,
+        };
+        ctx->getQueue().WriteBuffer(colliderGridUniformBuffer, 0, &grid, sizeof(grid));
+        if (!colliders.empty())
+        {
+            ctx->getQueue().WriteBuffer(colliderBuffer, 0, colliders.data(), colliders.size() * sizeof(ColliderData));
+        }
+    }
+
+
+    void ComputeManager::updateMovedChunks(const Camera& camera)
+    {
+        movedChunks.clear();
+        for (const uint32_t chunkIndex : visibleChunks)
+        {
+            const GrassChunk& chunk = chunks[chunkIndex];
+            const glm::vec3 closest = glm::clamp(camera.position, chunk.boundsMin, chunk.boundsMax);
+            const uint32_t interval = config->amortizedMovement
+                                          ? getMovementInterval(config->movementIntervalDistances,
+                                                                glm::distance(camera.position, closest))
+                                          : 1;
+            // Phased by the world coordinate so the distant chunks are spread over the frames
+            const auto phase = static_cast<uint32_t>(hashBytes(&chunk.coord, sizeof(chunk.coord)));
+            if (((movementFrame + phase) & (interval - 1)) == 0) movedChunks.push_back(chunkIndex);
+        }
+        movementFrame++;
+    }
+
+
+    void ComputeManager::computeMovement(FrameGraph& frameGraph, const Camera& camera, float time)
+    {
+        TRACE_ZONE("ComputeManager::computeMovement");
+        updateMovedChunks(camera);
+        // Covers the culling distance, with a texel of margin for the snapping below.
+        // Snapped to whole texels so the wind field doesn't shimmer when the camera moves.
+        const float texelSize = 2.0f * config->cullUniform.maxDistance /
+            static_cast<float>(config->windFieldResolution - 2);
+        const glm::vec2 cameraTexel = glm::vec2(camera.position.x, camera.position.z) / texelSize;
+        const MovFrameUniformData movFrame = {
+            .time = time,
+            .windFieldSize = texelSize * static_cast<float>(config->windFieldResolution),
+            .windFieldOrigin = (glm::floor(cameraTexel) - 0.5f * static_cast<float>(config->windFieldResolution)) *
+            texelSize,
+        };
+        ctx->getQueue().WriteBuffer(movDynamicUniformBuffer, 0, &movFrame, movDynamicUniformBuffer.GetSize());
+
+        // The trample window covers the culling distance like the collider grid, and also moves by whole texels.
+        // Its texels keep their world position (see trample.wgsl).
+        const GrassGenUniformData& gen = config->grassUniform;
+        const float trampleTexelSize = 2.0f * config->cullUniform.maxDistance /
+            static_cast<float>(config->trampleResolution - 2);
+        const glm::vec2 cameraXZ = {camera.position.x, camera.position.z};
+        const glm::ivec2 trampleOriginTexel = glm::ivec2(glm::floor(cameraXZ / trampleTexelSize)) -
+            static_cast<int32_t>(config->trampleResolution / 2);
+        const float elapsed = std::max(time - trampleTime, 0.0f);
+        // The trails no longer match their texels once the culling distance changed
+        const bool keepTrails = config->trampleRecoveryTime > 0.0f && trampleTexelSize == previousTrampleTexelSize;
+        const TrampleUniformData trampleFrame = {
+            .originTexel = trampleOriginTexel,
+            .previousOriginTexel = previousTrampleOriginTexel,
+            .texelSize = trampleTexelSize,
+            .resolution = config->trampleResolution,
+            .decay = keepTrails ? std::exp(-elapsed / config->trampleRecoveryTime) : 0.0f,
+            .bladeHeight = gen.bladeHeight + gen.sizeNoiseAmplitude,
+        };
+        ctx->getQueue().WriteBuffer(trampleUniformBuffer, 0, &trampleFrame, sizeof(trampleFrame));
+        previousTrampleOriginTexel = trampleOriginTexel;
+        previousTrampleTexelSize = trampleTexelSize;
+        trampleTime = time;
+        // Stamped from the texture written by the previous frame
+        trampleIndex = 1 - trampleIndex;
+
+        frameGraph.addPass(
+            "Wind and movement", FramePassType::Compute,
+            {staticBladeBuffer, dynamicBladeBuffer, colliderBuffer, terrainHeightmap,
+             trampleTextures[1 - trampleIndex]},
+            {windFieldTexture, dynamicBladeBuffer, colliderCellCountBuffer, colliderCellBuffer,
+             trampleTextures[trampleIndex]},
+            [this, chunkIndices = movedChunks, colliderCount = colliders.size(), trampleIndex = trampleIndex](
+            const wgpu::CommandEncoder& encoder)
+            {
+                encoder.ClearBuffer(colliderCellCountBuffer, 0, colliderCellCountBuffer.GetSize());
+
+                wgpu::ComputePassDescriptor computePassDesc = {
+                    .label = "Movement compute pass",
+                    .timestampWrites = ctx->getProfiler().computePass("Wind and movement")
+                };
+                wgpu::ComputePassEncoder pass = encoder.BeginComputePass(&computePassDesc);
+
+                // Noise is evaluated once per texel instead of once per blade
+                const uint32_t windWorkgroups = (config->windFieldResolution + 7) / 8;
+                pass.SetPipeline(windPipeline);
+                pass.SetBindGroup(0, windBindGroup);
+                pass.DispatchWorkgroups(windWorkgroups, windWorkgroups, 1);
+
+                // Each trample texel then only tests the colliders of its cell
+                if (colliderCount > 0)
+                {
+                    pass.SetPipeline(colliderBinPipeline);
+                    pass.SetBindGroup(0, colliderBinBindGroup);
+                    pass.DispatchWorkgroups(static_cast<uint32_t>((colliderCount + 63) / 64), 1, 1);
+                }
+
+                // Runs without colliders too, the trails keep fading
+                const uint32_t trampleWorkgroups = (config->trampleResolution + 7) / 8;
+                pass.SetPipeline(tramplePipeline);
+                pass.SetBindGroup(0, trampleBindGroups[trampleIndex]);
+                pass.SetBindGroup(1, terrainSampleBindGroup);
+                pass.SetBindGroup(2, trampleColliderBindGroup);
+                pass.DispatchWorkgroups(trampleWorkgroups, trampleWorkgroups, 1);
+
+                // Blades read a single trample texel instead of testing the colliders
+                pass.SetPipeline(movPipeline);
+                pass.SetBindGroup(0, movBladeBinding.bindGroup);
+                pass.SetBindGroup(1, movBindGroups[trampleIndex]);
+                // Chunks outside the view or skipped this frame keep their last pose
+                dispatchChunks(pass, chunkIndices);
+                pass.End();
+            }
+        );
+    }
+
+
+    void ComputeManager::streamChunks(FrameGraph& frameGraph, const Camera& camera)
+    {
+        TRACE_ZONE("ComputeManager::streamChunks");
+        if (!config->infiniteTerrain) return;
+
+        const GrassGenUniformData& gen = config->grassUniform;
+        const auto chunksPerSide = static_cast<int32_t>(config->chunksPerSide);
+        const float chunkSize = static_cast<float>(config->chunkBladesPerSide) / gen.density;
+        const glm::vec2 cameraCell = (glm::vec2(camera.position.x, camera.position.z) + gen.sideLength) / chunkSize;
+        const glm::ivec2 ringOrigin = glm::ivec2(glm::floor(cameraCell)) - chunksPerSide / 2;
+
+        // Each slot holds the ring chunk congruent to it modulo the ring size, so crossing a chunk
+        // boundary only remaps the row or column that left the ring
+        streamedChunks.clear();
+        for (uint32_t chunkIndex = 0; chunkIndex < chunks.size(); chunkIndex++)
+        {
+            const glm::ivec2 slot{chunkIndex % chunksPerSide, chunkIndex / chunksPerSide};
+            const glm::ivec2 coord = ringOrigin + ((slot - ringOrigin) % chunksPerSide + chunksPerSide) % chunksPerSide;
+            if (coord == chunks[chunkIndex].coord) continue;
+            setChunkCoord(chunkIndex, coord);
+            streamedChunks.push_back(chunkIndex);
+        }
+
+        if (!streamedChunks.empty())
+        {
+            generateChunks(frameGraph, streamedChunks);
+        }
+    }
+
+
+    void ComputeManager::updateVisibleChunks(const Camera& camera)
+    {
+        TRACE_ZONE("ComputeManager::updateVisibleChunks");
+        const auto planes = camera.getFrustumPlanes();
+        visibleChunks.clear();
+        for (uint32_t chunkIndex = 0; chunkIndex < chunks.size(); chunkIndex++)
+        {
+            const GrassChunk& chunk = chunks[chunkIndex];
+            const glm::vec3 closestPoint = glm::clamp(camera.position, chunk.boundsMin, chunk.boundsMax);
+            if (glm::distance(closestPoint, camera.position) > config->cullUniform.maxDistance) continue;
+            if (config->cullUniform.frustumCulling != 0 && !isBoxInFrustum(planes, chunk.boundsMin, chunk.boundsMax))
+                continue;
+            visibleChunks.push_back(chunkIndex);
+        }
+    }
+
+
+    void ComputeManager::cullBlades(FrameGraph& frameGraph, const Camera& camera)
+    {
+        TRACE_ZONE("ComputeManager::cullBlades");
+        const auto planes = camera.getFrustumPlanes();
+        std::copy(planes.begin(), planes.end(), config->cullUniform.frustumPlanes);
+        config->cullUniform.cameraPosition = camera.position;
+        ctx->getQueue().WriteBuffer(cullUniformBuffer, 0, &config->cullUniform, cullUniformBuffer.GetSize());
+
+        frameGraph.addPass(
+            "Culling", FramePassType::Compute, {staticBladeBuffer, dynamicBladeBuffer},
+            {visibleBladesBuffer, drawArgsBuffer},
+            [this, chunkIndices = visibleChunks](const wgpu::CommandEncoder& encoder)
+            {
+                // Reset instance counts only, index counts are owned by the Renderer
+                for (uint32_t lod = 0; lod < BLADE_LOD_COUNT; lod++)
+                {
+                    encoder.ClearBuffer(drawArgsBuffer,
+                                        lod * sizeof(DrawIndexedIndirectArgs) +
+                                        offsetof(DrawIndexedIndirectArgs, instanceCount),
+                                        sizeof(uint32_t));
+                }
+
+                wgpu::ComputePassDescriptor computePassDesc = {
+                    .label = "Culling compute pass",
+                    .timestampWrites = ctx->getProfiler().computePass("Culling")
+                };
+                wgpu::ComputePassEncoder pass = encoder.BeginComputePass(&computePassDesc);
+
+                pass.SetPipeline(cullPipeline);
+                pass.SetBindGroup(0, cullBladeBinding.bindGroup);
+                pass.SetBindGroup(1, cullBindGroup);
+                // Blades of hidden chunks never reach the visible lists, so they are never drawn
+                dispatchChunks(pass, chunkIndices);
+                pass.End();
+            }
+        );
     }
 } // grass
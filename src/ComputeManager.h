@@ -2,55 +2,226 @@
 
 #include <webgpu/webgpu_cpp.h>
 #include <glm/glm.hpp>
+#include <array>
+#include <future>
+#include <vector>
 
+#include "Camera.h"
+#include "FrameGraph.h"
 #include "GPUContext.h"
 #include "GlobalConfig.h"
+#include "Mesh.h"
+#include "StartupScheduler.h"
 
 namespace grass
 {
-    struct Blade
+    struct ImageData;
+
+
+    // Written once by generation
+    struct BladeStatic
     {
         glm::vec3 c0;
         float idHash;
-        glm::vec2 uv;
+        glm::vec2 facingDirection; // xz, the blade always stands in the horizontal plane
         float height;
         float relativeHeight;
-        glm::vec4 c1;
-        glm::vec4 c2;
-        glm::vec3 facingDirection;
+        glm::vec3 up; // terrain normal
+        float padding;
+    };
+
+    // Written every frame by movement
+    struct BladeDynamic
+    {
+        glm::vec3 c1;
         float collisionStrength;
+        glm::vec3 c2;
+        float padding;
+    };
+
+    // Quantized counterparts, see blade_layout_packed.wgsl
+    struct PackedBladeStatic
+    {
+        glm::vec3 c0;
+        uint32_t heightFacingRelative; // height f16 | facing angle unorm8 | relativeHeight unorm8
+        uint32_t idHashUp; // idHash unorm16 | up.xz snorm8x2
+    };
+
+    struct PackedBladeDynamic
+    {
+        uint32_t c1xy; // f16x2 offset from c0
+        uint32_t c1zC2; // f16 offset from c0 | f16 c2 height
+        uint32_t collisionStrength; // unorm16
+    };
+
+    // Same layout as the arguments read by DrawIndexedIndirect
+    struct DrawIndexedIndirectArgs
+    {
+        uint32_t indexCount;
+        uint32_t instanceCount;
+        uint32_t firstIndex;
+        int32_t baseVertex;
+        uint32_t firstInstance;
+    };
+
+    // GPU buffers written by the compute passes and read by the Renderer
+    struct BladeBuffers
+    {
+        wgpu::Buffer staticBlades;
+        wgpu::Buffer dynamicBlades;
+        // One list of visible blade indices per LOD, each lodStride bytes apart
+        wgpu::Buffer visibleBlades;
+        uint64_t lodStride = 0;
+        // One DrawIndexedIndirectArgs per LOD
+        wgpu::Buffer drawArgs;
+    };
+
+    // CPU side of a chunk, its GPU side is a ChunkUniformData
+    struct GrassChunk
+    {
+        // Covers the blades of the chunk in any pose
+        glm::vec3 boundsMin;
+        glm::vec3 boundsMax;
+        glm::ivec2 coord{}; // position in the world chunk grid
+        ChunkUniformData uniform;
+        uint32_t uniformOffset = 0;
     };
 
     class ComputeManager
     {
     public:
         explicit ComputeManager(std::shared_ptr<GlobalConfig> config);
-        wgpu::Buffer init();
+        // Pipelines are created by the scheduler, they are ready once it has waited
+        BladeBuffers init(StartupScheduler& scheduler);
         void updateMovSettingsUniorm();
-        void generate();
-        void computeMovement(float time);
+        // Passes are added to the frame graph, they run when it executes
+        void generate(FrameGraph& frameGraph);
+        void requestHeightUpdate();
+        void updateHeights(FrameGraph& frameGraph);
+        // Gathers the camera and scene mesh colliders for the next movement pass
+        void updateColliders(const std::vector<Mesh>& scene, const Camera& camera);
+        void computeMovement(FrameGraph& frameGraph, const Camera& camera, float time);
+        void streamChunks(FrameGraph& frameGraph, const Camera& camera);
+        void updateVisibleChunks(const Camera& camera);
+        void cullBlades(FrameGraph& frameGraph, const Camera& camera);
+        [[nodiscard]] size_t getVisibleChunkCount() const { return visibleChunks.size(); }
+        // Visible chunks updated by the latest movement pass
+        [[nodiscard]] size_t getMovedChunkCount() const { return movedChunks.size(); }
+        [[nodiscard]] size_t getColliderCount() const { return colliders.size(); }
 
     private:
-        bool createSharedBuffer();
-        bool createSharedBindGroup();
+        // Blade buffers bound with the access a pass needs
+        struct BladeBinding
+        {
+            wgpu::BindGroupLayout layout;
+            wgpu::BindGroup bindGroup;
+        };
+
+        bool createBladeBuffers();
+        bool createBladeBindGroup(wgpu::BufferBindingType staticType, wgpu::BufferBindingType dynamicType,
+                                  const char* label, BladeBinding& binding);
+        bool createChunks();
+        void setChunkCoord(uint32_t chunkIndex, const glm::ivec2& coord);
+        // From the current generation settings, for chunks regenerated with them
+        void updateChunkBounds(const std::vector<uint32_t>& chunkIndices);
+        void generateChunks(FrameGraph& frameGraph, const std::vector<uint32_t>& chunkIndices);
+        void updateMovedChunks(const Camera& camera);
         bool createUniformBuffers();
-        bool initGenPipeline();
-        bool initMovPipeline();
+        bool createWindField(StartupScheduler& scheduler);
+        bool createColliderBuffers(StartupScheduler& scheduler);
+        bool createTrampleMap();
+        bool initTramplePipeline(StartupScheduler& scheduler);
+        bool createTerrain(StartupScheduler& scheduler, std::future<ImageData>& heightmapImage);
+        bool createTerrainSampleBindGroup();
+        bool createCullBuffers();
+        bool initGenPipeline(StartupScheduler& scheduler);
+        bool initMovPipeline(StartupScheduler& scheduler);
+        bool initCullPipeline(StartupScheduler& scheduler);
+        void initDispatchConstants();
+        void dispatchBlades(const wgpu::ComputePassEncoder& pass) const;
+        void dispatchChunks(const wgpu::ComputePassEncoder& pass, const std::vector<uint32_t>& chunkIndices) const;
 
         std::shared_ptr<GlobalConfig> config;
         GPUContext* ctx = nullptr;
 
-        wgpu::Buffer computeBuffer;
-        wgpu::BindGroupLayout sharedLayout;
-        wgpu::BindGroup sharedBindGroup;
+        std::array<wgpu::ConstantEntry, 3> dispatchConstants;
+
+        wgpu::Buffer staticBladeBuffer;
+        wgpu::Buffer dynamicBladeBuffer;
+        BladeBinding genBladeBinding;
+        BladeBinding movBladeBinding;
+        BladeBinding cullBladeBinding;
+
+        std::vector<GrassChunk> chunks;
+        std::vector<uint32_t> allChunks;
+        std::vector<uint32_t> visibleChunks;
+        std::vector<uint32_t> streamedChunks;
+        std::vector<uint32_t> movedChunks;
+        uint32_t movementFrame = 0;
+        uint64_t chunkStride = 0;
+        wgpu::Buffer chunkUniformBuffer;
+        wgpu::BindGroupLayout chunkBindGroupLayout;
+        wgpu::BindGroup chunkBindGroup;
+
+        wgpu::Texture terrainHeightmap;
+        wgpu::TextureView terrainHeightmapView;
+        wgpu::Sampler terrainSampler;
+        glm::vec2 terrainHeightRange{};
+        // The procedural terrain is baked before the first generation
+        bool terrainBakePending = false;
+        wgpu::ComputePipeline terrainPipeline;
+        wgpu::BindGroup terrainBindGroup;
+        // Generation settings and the sampled heightmap, group 1 of the passes including terrain.wgsl
+        wgpu::BindGroupLayout terrainSampleBindGroupLayout;
+        wgpu::BindGroup terrainSampleBindGroup;
 
         wgpu::ComputePipeline genPipeline;
         wgpu::Buffer genSettingsUniformBuffer;
-        wgpu::BindGroup genBindGroup;
+        wgpu::ComputePipeline heightPipeline;
+
+        // Height updates requested since the last frame, and chunks still waiting for the latest one
+        bool heightUpdatePending = false;
+        std::vector<uint32_t> heightUpdateQueue;
+        size_t heightUpdateCursor = 0;
+
+        wgpu::ComputePipeline windPipeline;
+        wgpu::Texture windFieldTexture;
+        wgpu::TextureView windFieldView;
+        wgpu::Sampler windFieldSampler;
+        wgpu::BindGroup windBindGroup;
+
+        std::vector<ColliderData> colliders;
+        wgpu::Buffer colliderGridUniformBuffer;
+        wgpu::Buffer colliderBuffer;
+        // Collider count then collider indices of each grid cell, rebuilt every frame
+        wgpu::Buffer colliderCellCountBuffer;
+        wgpu::Buffer colliderCellBuffer;
+        wgpu::ComputePipeline colliderBinPipeline;
+        wgpu::BindGroup colliderBinBindGroup;
+
+        // Ping-pong pair, each frame stamps one texture from the other. Bind group i writes texture i.
+        std::array<wgpu::Texture, 2> trampleTextures;
+        std::array<wgpu::TextureView, 2> trampleViews;
+        std::array<wgpu::BindGroup, 2> trampleBindGroups;
+        wgpu::BindGroup trampleColliderBindGroup;
+        wgpu::ComputePipeline tramplePipeline;
+        wgpu::Buffer trampleUniformBuffer;
+        uint32_t trampleIndex = 0; // texture written by the latest movement
+        glm::ivec2 previousTrampleOriginTexel{};
+        float previousTrampleTexelSize = 0.0f;
+        float trampleTime = 0.0f;
 
         wgpu::ComputePipeline movPipeline;
         wgpu::Buffer movSettingsUniformBuffer;
         wgpu::Buffer movDynamicUniformBuffer;
-        wgpu::BindGroup movBindGroup;
+        // Bind group i reads trample texture i
+        std::array<wgpu::BindGroup, 2> movBindGroups;
+
+        wgpu::ComputePipeline cullPipeline;
+        wgpu::Buffer cullUniformBuffer;
+        wgpu::Buffer visibleBladesBuffer;
+        uint64_t lodStride = 0;
+        wgpu::Buffer drawArgsBuffer;
+        wgpu::BindGroup cullBindGroup;
     };
 } // grass
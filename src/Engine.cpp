@@ -6,9 +6,13 @@
 #include <backends/imgui_impl_wgpu.h>
 #include <backends/imgui_impl_glfw.h>
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 
 #include "Mesh.h"
+#include "MeshFile.h"
+#include "Tracer.h"
 #include "Utils.h"
 
 
@@ -18,25 +22,60 @@ namespace grass
     Engine& Engine::getInstance() { return *loadedEngine; }
 
 
-    bool Engine::init()
+    bool Engine::init(std::shared_ptr<GlobalConfig> globalConfig)
     {
+        TRACE_ZONE("Engine::init");
         assert(loadedEngine == nullptr);
         loadedEngine = this;
 
         keysArePressed = new bool[512]{false};
-        config = std::make_shared<GlobalConfig>();
+        config = std::move(globalConfig);
 
-        if (!initWindow()) return false;
-        GPUContext::getInstance(window)->configSurface(WIDTH, HEIGHT);
+        uint16_t width = WIDTH;
+        uint16_t height = HEIGHT;
+        if (config->headless)
+        {
+            width = static_cast<uint16_t>(config->headlessSize.x);
+            height = static_cast<uint16_t>(config->headlessSize.y);
+            camera.aspect = static_cast<float>(width) / static_cast<float>(height);
+            GPUContext::initHeadless(config->headlessFormat, config->forceFallbackAdapter)->configSurface(width, height);
+        }
+        else
+        {
+            if (!initWindow()) return false;
+            GPUContext::getInstance(window)->configSurface(width, height, config->vsync);
+        }
 
         computeManager = std::make_unique<ComputeManager>(config);
-        renderer = std::make_unique<Renderer>(config, WIDTH, HEIGHT);
+        renderer = std::make_unique<Renderer>(config, width, height);
+
+        // Every pipeline is issued before the first wait, startup is bounded by the slowest one
+        StartupScheduler scheduler;
+        auto portalImage = scheduler.load([] { return loadImageData("../assets/portal_color.png"); });
+        auto portalMeshFile = scheduler.load([] { return MeshFile::import("../assets/portal.obj"); });
 
-        wgpu::Buffer computeBuffer = computeManager->init();
-        if (computeBuffer == nullptr) return false;
-        if (!renderer->init(computeBuffer)) return false;
-        if (!initGUI()) return false;
+        const BladeBuffers bladeBuffers = computeManager->init(scheduler);
+        if (bladeBuffers.staticBlades == nullptr) return false;
+        if (!renderer->init(bladeBuffers, scheduler)) return false;
+        if (!config->headless && !initGUI()) return false;
 
+        PhongMaterial portalCol{createTexture(portalImage.get())};
+        auto portalMesh = Mesh(MeshGeomoetry("../assets/portal.obj", portalMeshFile.get()), portalCol);
+        portalMesh.model = glm::translate(portalMesh.model, glm::vec3{0.61, 0.12, 0.5});
+        portalMesh.model = glm::scale(portalMesh.model, glm::vec3{0.3});
+        // Stone and pillars, in portal space
+        portalMesh.colliders = {
+            {.a = {-2.8, 1.0, 2.17}, .b = {-2.8, 1.0, 2.17}, .radius = 2.33},
+            {.a = {-2.03, 0.8, 0.12}, .b = {-2.03, 3.2, 0.12}, .radius = 0.85},
+            {.a = {2.03, 0.8, 0.04}, .b = {2.03, 3.2, 0.04}, .radius = 0.85},
+        };
+        scene = {portalMesh};
+
+        if (!scheduler.wait())
+        {
+            std::cerr << "Could not create the pipelines!" << std::endl;
+            return false;
+        }
         return true;
     }
 
@@ -187,13 +226,56 @@ namespace grass
 
     void Engine::updateGUI()
     {
+        TRACE_ZONE("Engine::updateGUI");
         ImGui_ImplWGPU_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
         {
             ImGui::Begin("Settings");
-            ImGui::Text("Number of blades : %i", config->totalBlades);
+            ImGui::Text("Number of blades : %zu", config->getBladeCount());
+            ImGui::Text("Visible chunks : %zu / %zu", computeManager->getVisibleChunkCount(), config->chunkCount);
+            ImGui::Text("Moved chunks : %zu", computeManager->getMovedChunkCount());
+            ImGui::Text("Colliders : %zu", computeManager->getColliderCount());
+            const GPUObjectCache& objectCache = GPUContext::getInstance()->getObjectCache();
+            ImGui::Text("Cached GPU objects : %zu (%zu reuses)", objectCache.getObjectCount(),
+                        objectCache.getHitCount());
+            const ShaderManager& shaderManager = GPUContext::getInstance()->getShaderManager();
+            ImGui::Text("Shader modules : %zu (%zu reuses)", shaderManager.getModuleCount(),
+                        shaderManager.getHitCount());
             ImGui::Text("%.3f ms/frame (%.1f FPS)", 1000.0f / io->Framerate, io->Framerate);
+            if (Tracer::isEnabled() && ImGui::Button("Dump CPU trace"))
+            {
+                Tracer::dump(TRACE_PATH);
+            }
+            if (ImGui::CollapsingHeader("GPU timings"))
+            {
+                const GPUProfiler& profiler = GPUContext::getInstance()->getProfiler();
+                if (!profiler.isEnabled())
+                {
+                    ImGui::Text("Timestamp queries are not supported");
+                }
+                else if (ImGui::BeginTable("GPU timings", 4))
+                {
+                    ImGui::TableSetupColumn("Pass");
+                    ImGui::TableSetupColumn("Min (ms)");
+                    ImGui::TableSetupColumn("Avg (ms)");
+                    ImGui::TableSetupColumn("Max (ms)");
+                    ImGui::TableHeadersRow();
+                    for (const auto& timing : profiler.getTimings())
+                    {
+                        ImGui::TableNextRow();
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%s", timing.name.c_str());
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%.3f", timing.minMs);
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%.3f", timing.avgMs);
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%.3f", timing.maxMs);
+                    }
+                    ImGui::EndTable();
+                }
+            }
             if (ImGui::CollapsingHeader("Generation", ImGuiTreeNodeFlags_DefaultOpen))
             {
                 bool genChange = false;
@@ -205,7 +287,7 @@ namespace grass
                                                 "%.2f");
                 if (genChange)
                 {
-                    computeManager->generate();
+                    computeManager->requestHeightUpdate();
                 }
             }
 
@@ -219,6 +301,20 @@ namespace grass
                 {
                     computeManager->updateMovSettingsUniorm();
                 }
+                ImGui::Checkbox("Amortized distant movement", &config->amortizedMovement);
+            }
+
+            if (ImGui::CollapsingHeader("Culling", ImGuiTreeNodeFlags_DefaultOpen))
+            {
+                bool frustumCulling = config->cullUniform.frustumCulling != 0;
+                if (ImGui::Checkbox("Frustum culling", &frustumCulling))
+                {
+                    config->cullUniform.frustumCulling = frustumCulling ? 1 : 0;
+                }
+                ImGui::SliderFloat("Max distance", &config->cullUniform.maxDistance, 5.0, 100.0, "%.1f");
+                ImGui::SliderFloat("LOD 1 distance", &config->cullUniform.lodDistances.x, 0.0, 50.0, "%.1f");
+                ImGui::SliderFloat("LOD 2 distance", &config->cullUniform.lodDistances.y,
+                                   config->cullUniform.lodDistances.x, 50.0, "%.1f");
             }
 
             if (ImGui::CollapsingHeader("Blade material", ImGuiTreeNodeFlags_DefaultOpen))
@@ -269,33 +365,74 @@ namespace grass
 
     void Engine::run()
     {
-        computeManager->generate();
+        computeManager->generate(frameGraph);
         computeManager->updateMovSettingsUniorm();
-        computeManager->computeMovement(time);
-        updateGUI();
+        computeManager->computeMovement(frameGraph, camera, time);
+        frameGraph.execute();
+        if (!config->headless)
+            updateGUI();
 
-        // Little preview scene
-        PhongMaterial portalCol{loadTexture("../assets/portal_color.png")};
-        auto portalGeo = MeshGeomoetry("../assets/portal.obj");
-        auto portalMesh = Mesh(portalGeo, portalCol);
-        portalMesh.model = glm::translate(portalMesh.model, glm::vec3{0.61, 0.12, 0.5});
-        portalMesh.model = glm::scale(portalMesh.model, glm::vec3{0.3});
+        const auto startTime = std::chrono::steady_clock::now();
+        while (config->headless ? frameNumber < config->headlessFrameCount : !glfwWindowShouldClose(window))
+        {
+            TRACE_ZONE("Frame");
+            if (config->headless)
+            {
+                time += HEADLESS_DELTA_TIME;
+            }
+            else
+            {
+                TRACE_ZONE("Input");
+                time += io->DeltaTime;
+                keyInput();
+                glfwPollEvents();
+            }
+            {
+                TRACE_ZONE("Camera::updateMatrix");
+                camera.updateMatrix();
+            }
+            GPUContext::getInstance()->getProfiler().beginFrame();
+
+            computeManager->streamChunks(frameGraph, camera);
+            computeManager->updateVisibleChunks(camera);
+            computeManager->updateHeights(frameGraph);
+            computeManager->updateColliders(scene, camera);
+            computeManager->computeMovement(frameGraph, camera, time);
+            computeManager->cullBlades(frameGraph, camera);
+            const bool rendered = renderer->render(frameGraph, scene, camera, time, frameNumber);
+            frameGraph.execute();
+            if (rendered)
+                GPUContext::getInstance()->present();
+            GPUContext::getInstance()->processEvents();
+            if (!config->headless)
+                updateGUI();
 
-        const auto scene = {portalMesh};
+            frameNumber++;
+        }
 
-        while (!glfwWindowShouldClose(window))
+        if (config->headless)
         {
-            time += io->DeltaTime;
+            GPUContext::getInstance()->waitIdle();
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+            GPUContext::getInstance()->processEvents();
+            printHeadlessReport(elapsed.count());
+            if (Tracer::isEnabled())
+                Tracer::dump(TRACE_PATH);
+        }
+    }
 
-            keyInput();
-            glfwPollEvents();
-            camera.updateMatrix();
 
-            computeManager->computeMovement(time);
-            renderer->render(scene, camera, time, frameNumber);
-            updateGUI();
+    void Engine::printHeadlessReport(double elapsedMs) const
+    {
+        std::cout << "Rendered " << frameNumber << " frames at " << config->headlessSize.x << "x"
+            << config->headlessSize.y << " in " << elapsedMs << " ms ("
+            << elapsedMs / std::max(frameNumber, 1u) << " ms/frame)" << std::endl;
 
-            frameNumber++;
+        const GPUProfiler& profiler = GPUContext::getInstance()->getProfiler();
+        for (const auto& timing : profiler.getTimings())
+        {
+            std::cout << "  " << timing.name << ": avg " << timing.avgMs << " ms, min " << timing.minMs
+                << " ms, max " << timing.maxMs << " ms" << std::endl;
         }
     }
 
@@ -303,6 +440,8 @@ namespace grass
     void Engine::cleanup()
     {
         delete [] keysArePressed;
+        if (config->headless) return;
+
         ImGui_ImplGlfw_Shutdown();
         ImGui_ImplWGPU_Shutdown();
         glfwDestroyWindow(window);
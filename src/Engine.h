@@ -9,6 +9,7 @@
 #include "GlobalConfig.h"
 #include "Renderer.h"
 #include "ComputeManager.h"
+#include "FrameGraph.h"
 #include "Camera.h"
 
 
@@ -18,11 +19,15 @@ namespace grass
     {
         const uint16_t WIDTH = 1600;
         const uint16_t HEIGHT = 900;
+        // Simulated time step of headless frames
+        const float HEADLESS_DELTA_TIME = 1.0f / 60.0f;
+        // Written by the GUI button, or at the end of a headless run, when tracing is compiled in
+        const char* TRACE_PATH = "trace.json";
 
     public:
         static Engine& getInstance();
 
-        bool init();
+        bool init(std::shared_ptr<GlobalConfig> globalConfig = std::make_shared<GlobalConfig>());
         void run();
         void cleanup();
 
@@ -34,9 +39,13 @@ namespace grass
         void mouseCallback(GLFWwindow* window, float xpos, float ypos);
         void mouseButtonCallback(GLFWwindow* window, int button, int action);
         void keyInput();
+        void printHeadlessReport(double elapsedMs) const;
 
         std::unique_ptr<Renderer> renderer;
         std::unique_ptr<ComputeManager> computeManager;
+        FrameGraph frameGraph;
+        // Little preview scene, referenced by the render passes until the frame graph executes
+        std::vector<Mesh> scene;
 
         std::shared_ptr<GlobalConfig> config;
 
@@ -0,0 +1,67 @@
+#include "FrameBufferAllocator.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "GPUContext.h"
+
+namespace grass
+{
+    bool FrameBufferAllocator::init(std::string label, uint64_t frameCapacity, wgpu::BufferUsage usage)
+    {
+        ctx = GPUContext::getInstance();
+        this->label = std::move(label);
+        this->usage = usage;
+        alignment = usage == wgpu::BufferUsage::Storage
+                        ? ctx->getLimits().minStorageBufferOffsetAlignment
+                        : ctx->getLimits().minUniformBufferOffsetAlignment;
+        return createBuffer(alignSize(frameCapacity));
+    }
+
+
+    bool FrameBufferAllocator::createBuffer(uint64_t capacity)
+    {
+        frameCapacity = capacity;
+        frameIndex = 0;
+        wgpu::BufferDescriptor bufferDesc = {
+            .label = label.c_str(),
+            .usage = usage | wgpu::BufferUsage::CopyDst,
+            .size = frameCapacity * FRAMES_IN_FLIGHT,
+            .mappedAtCreation = false
+        };
+        buffer = ctx->getDevice().CreateBuffer(&bufferDesc);
+        return buffer != nullptr;
+    }
+
+
+    void FrameBufferAllocator::beginFrame()
+    {
+        frameIndex = (frameIndex + 1) % FRAMES_IN_FLIGHT;
+        staging.clear();
+    }
+
+
+    uint32_t FrameBufferAllocator::allocate(const void* data, uint64_t size)
+    {
+        const uint64_t offset = staging.size();
+        staging.resize(offset + alignSize(size));
+        std::memcpy(staging.data() + offset, data, size);
+        return static_cast<uint32_t>(offset);
+    }
+
+
+    bool FrameBufferAllocator::upload()
+    {
+        bool recreated = false;
+        // Commands already recorded keep the previous buffer alive
+        if (staging.size() > frameCapacity)
+        {
+            recreated = createBuffer(alignSize(std::max<uint64_t>(staging.size(), frameCapacity * 2)));
+        }
+        if (!staging.empty())
+        {
+            ctx->getQueue().WriteBuffer(buffer, getFrameOffset(), staging.data(), staging.size());
+        }
+        return recreated;
+    }
+} // grass
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <webgpu/webgpu_cpp.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class GPUContext;
+
+namespace grass
+{
+    // Uniform or storage data of a frame sub-allocated from one ring buffer and bound with dynamic offsets.
+    // The ring holds FRAMES_IN_FLIGHT frame slices, a frame never overwrites the slice of a frame the GPU may still
+    // be reading. Allocations are gathered on the CPU and written with a single queue write per frame.
+    class FrameBufferAllocator
+    {
+    public:
+        // Same as the frames ImGui keeps in flight
+        static constexpr uint32_t FRAMES_IN_FLIGHT = 3;
+
+        // The capacity of a frame grows when a frame needs more. Usage is Uniform or Storage, it sets the alignment.
+        bool init(std::string label, uint64_t frameCapacity, wgpu::BufferUsage usage);
+        // Moves to the next slice of the ring, the previous allocations are dropped
+        void beginFrame();
+        // Copies the data into the frame, returns its offset from the frame start
+        uint32_t allocate(const void* data, uint64_t size);
+        template <typename T>
+        uint32_t allocate(const T& data) { return allocate(&data, sizeof(T)); }
+        // Writes the frame's allocations, before its submit. True when the buffer was recreated to grow, the bind
+        // groups using it must then be recreated.
+        bool upload();
+
+        // Dynamic offsets are the frame offset plus the allocation offset
+        [[nodiscard]] uint32_t getFrameOffset() const { return static_cast<uint32_t>(frameIndex * frameCapacity); }
+        [[nodiscard]] uint64_t getFrameCapacity() const { return frameCapacity; }
+        [[nodiscard]] const wgpu::Buffer& getBuffer() const { return buffer; }
+
+    private:
+        bool createBuffer(uint64_t capacity);
+        [[nodiscard]] uint64_t alignSize(uint64_t size) const { return (size + alignment - 1) / alignment * alignment; }
+
+        GPUContext* ctx = nullptr;
+        std::string label;
+        wgpu::BufferUsage usage = wgpu::BufferUsage::Uniform;
+        wgpu::Buffer buffer;
+        uint64_t alignment = 256;
+        uint64_t frameCapacity = 0;
+        uint32_t frameIndex = 0;
+        std::vector<uint8_t> staging;
+    };
+} // grass
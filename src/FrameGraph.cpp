@@ -0,0 +1,116 @@
+#include "FrameGraph.h"
+
+#include <algorithm>
+
+#include "GPUContext.h"
+#include "Tracer.h"
+
+
+namespace grass
+{
+    namespace
+    {
+        bool accesses(const std::vector<FrameResource>& resources, const FrameResource& resource)
+        {
+            return std::any_of(resources.begin(), resources.end(),
+                               [&resource](const FrameResource& other) { return other.handle == resource.handle; });
+        }
+    }
+
+
+    void FrameGraph::addPass(std::string name, FramePassType type, std::vector<FrameResource> reads,
+                             std::vector<FrameResource> writes, RecordFunction record)
+    {
+        passes.push_back({std::move(name), type, std::move(reads), std::move(writes), std::move(record)});
+    }
+
+
+    std::vector<size_t> FrameGraph::sortPasses() const
+    {
+        // A pass depends on the earlier passes writing what it reads, and reading or writing what it writes
+        std::vector<std::vector<size_t>> dependents(passes.size());
+        std::vector<size_t> dependencyCounts(passes.size(), 0);
+        for (size_t later = 0; later < passes.size(); later++)
+        {
+            for (size_t earlier = 0; earlier < later; earlier++)
+            {
+                const Pass& first = passes[earlier];
+                const Pass& second = passes[later];
+                const bool readAfterWrite = std::any_of(second.reads.begin(), second.reads.end(),
+                                                        [&first](const FrameResource& resource)
+                                                        {
+                                                            return accesses(first.writes, resource);
+                                                        });
+                const bool writeAfterAccess = std::any_of(second.writes.begin(), second.writes.end(),
+                                                          [&first](const FrameResource& resource)
+                                                          {
+                                                              return accesses(first.writes, resource) ||
+                                                                  accesses(first.reads, resource);
+                                                          });
+                if (readAfterWrite || writeAfterAccess)
+                {
+                    dependents[earlier].push_back(later);
+                    dependencyCounts[later]++;
+                }
+            }
+        }
+
+        // Among the ready passes compute goes first, so independent compute work isn't split by render passes
+        const auto runsBefore = [this](size_t a, size_t b)
+        {
+            if (passes[a].type != passes[b].type) return passes[a].type == FramePassType::Compute;
+            return a < b;
+        };
+        std::vector<size_t> ready;
+        for (size_t i = 0; i < passes.size(); i++)
+        {
+            if (dependencyCounts[i] == 0) ready.push_back(i);
+        }
+
+        std::vector<size_t> order;
+        order.reserve(passes.size());
+        while (!ready.empty())
+        {
+            const auto next = std::min_element(ready.begin(), ready.end(), runsBefore);
+            const size_t passIndex = *next;
+            ready.erase(next);
+            order.push_back(passIndex);
+            for (const size_t dependent : dependents[passIndex])
+            {
+                if (--dependencyCounts[dependent] == 0) ready.push_back(dependent);
+            }
+        }
+        return order;
+    }
+
+
+    void FrameGraph::execute()
+    {
+        TRACE_ZONE("FrameGraph::execute");
+        if (passes.empty()) return;
+
+        GPUContext* ctx = GPUContext::getInstance();
+        wgpu::CommandEncoderDescriptor encoderDesc = {
+            .label = "Frame command encoder"
+        };
+        wgpu::CommandEncoder encoder = ctx->getDevice().CreateCommandEncoder(&encoderDesc);
+        for (const size_t passIndex : sortPasses())
+        {
+            encoder.PushDebugGroup(passes[passIndex].name.c_str());
+            passes[passIndex].record(encoder);
+            encoder.PopDebugGroup();
+        }
+        ctx->getProfiler().resolve(encoder);
+
+        wgpu::CommandBufferDescriptor cmdBufferDescriptor = {
+            .label = "Frame command buffer"
+        };
+        wgpu::CommandBuffer command = encoder.Finish(&cmdBufferDescriptor);
+        {
+            TRACE_ZONE("Submit");
+            ctx->getQueue().Submit(1, &command);
+        }
+        ctx->getProfiler().endFrame();
+        passes.clear();
+    }
+} // grass
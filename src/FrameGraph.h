@@ -0,0 +1,54 @@
+#pragma once
+
+#include <webgpu/webgpu_cpp.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace grass
+{
+    // GPU resource written or read by a pass, only its identity matters
+    struct FrameResource
+    {
+        FrameResource(const wgpu::Buffer& buffer) : handle(buffer.Get()) {}
+        FrameResource(const wgpu::Texture& texture) : handle(texture.Get()) {}
+        FrameResource(const wgpu::TextureView& view) : handle(view.Get()) {}
+
+        const void* handle;
+    };
+
+    enum class FramePassType
+    {
+        Compute,
+        Render,
+    };
+
+    // Passes of a frame recorded into a single command encoder and submitted once.
+    // Declaration order decides which write a pass sees, WebGPU inserts the barriers between passes.
+    class FrameGraph
+    {
+    public:
+        using RecordFunction = std::function<void(const wgpu::CommandEncoder& encoder)>;
+
+        void addPass(std::string name, FramePassType type, std::vector<FrameResource> reads,
+                     std::vector<FrameResource> writes, RecordFunction record);
+        // Records the passes in dependency order, resolves the profiler timestamps and submits
+        void execute();
+
+        [[nodiscard]] bool isEmpty() const { return passes.empty(); }
+
+    private:
+        struct Pass
+        {
+            std::string name;
+            FramePassType type;
+            std::vector<FrameResource> reads;
+            std::vector<FrameResource> writes;
+            RecordFunction record;
+        };
+
+        [[nodiscard]] std::vector<size_t> sortPasses() const;
+
+        std::vector<Pass> passes;
+    };
+} // grass
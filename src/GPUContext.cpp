@@ -1,23 +1,43 @@
 #include "GPUContext.h"
 
+#include "Tracer.h"
+
+#include <algorithm>
 #include <stdexcept>
 #include <iostream>
 
+#ifdef GRASS_ENABLE_PIPELINE_CACHE
+#include <dawn/native/DawnNative.h>
+
+// Relative to the working directory, like the shader and asset paths
+constexpr auto PIPELINE_CACHE_DIR = "pipeline_cache";
+#endif
+
 GPUContext* GPUContext::ctx = nullptr;
 
-GPUContext::GPUContext(GLFWwindow* window)
+GPUContext::GPUContext(GLFWwindow* window, wgpu::TextureFormat offscreenFormat, bool forceFallbackAdapter)
 {
     wgpu::InstanceDescriptor instanceDesc;
     instanceDesc.features.timedWaitAnyEnable = true;
+#ifdef GRASS_ENABLE_PIPELINE_CACHE
+    pipelineCachePlatform = std::make_unique<PipelineCachePlatform>(PIPELINE_CACHE_DIR);
+    dawn::native::DawnInstanceDescriptor dawnInstanceDesc;
+    dawnInstanceDesc.platform = pipelineCachePlatform.get();
+    instanceDesc.nextInChain = &dawnInstanceDesc;
+#endif
     instance = wgpu::CreateInstance(&instanceDesc);
     assert(instance && "Could not initialize WebGPU!");
 
-    surface = wgpu::glfw::CreateSurfaceForWindow(instance, window);
-    assert(surface && "Could not get Surface!");
+    if (window)
+    {
+        surface = wgpu::glfw::CreateSurfaceForWindow(instance, window);
+        assert(surface && "Could not get Surface!");
+    }
 
     wgpu::RequestAdapterOptions adapterOpts = {
         .compatibleSurface = surface,
         .powerPreference = wgpu::PowerPreference::HighPerformance,
+        .forceFallbackAdapter = forceFallbackAdapter,
     };
     wgpu::Adapter chosenAdapter;
 
@@ -55,9 +75,14 @@ GPUContext::GPUContext(GLFWwindow* window)
     dawnTogglesDesc.enabledToggles = toggles;
 
 
+    // Only used by the profiler, which is disabled without it
+    const bool timestampsSupported = chosenAdapter.HasFeature(wgpu::FeatureName::TimestampQuery);
+    const wgpu::FeatureName timestampFeature = wgpu::FeatureName::TimestampQuery;
+
     wgpu::DeviceDescriptor deviceDesc;
     deviceDesc.label = "Grass renderer device";
-    deviceDesc.requiredFeatureCount = 0;
+    deviceDesc.requiredFeatureCount = timestampsSupported ? 1 : 0;
+    deviceDesc.requiredFeatures = &timestampFeature;
     deviceDesc.requiredLimits = nullptr;
     deviceDesc.nextInChain = &dawnTogglesDesc;
     deviceDesc.SetDeviceLostCallback(
@@ -100,13 +125,29 @@ GPUContext::GPUContext(GLFWwindow* window)
     instance.WaitAny(deviceFuture, UINT64_MAX);
     assert(device && "Could not request device!");
 
-    wgpu::SurfaceCapabilities capabilities;
-    surface.GetCapabilities(chosenAdapter, &capabilities);
-    surfaceFormat = capabilities.formats[0];
+    if (surface)
+    {
+        wgpu::SurfaceCapabilities capabilities;
+        surface.GetCapabilities(chosenAdapter, &capabilities);
+        surfaceFormat = capabilities.formats[0];
+        presentModes.assign(capabilities.presentModes, capabilities.presentModes + capabilities.presentModeCount);
+    }
+    else
+    {
+        surfaceFormat = offscreenFormat;
+    }
     assert(surfaceFormat != wgpu::TextureFormat::Undefined && "Wrong surface format!");
 
     queue = device.GetQueue();
     assert(queue && "Could not get queue from device!");
+
+    wgpu::SupportedLimits supportedLimits;
+    device.GetLimits(&supportedLimits);
+    limits = supportedLimits.limits;
+
+    profiler = std::make_unique<GPUProfiler>(device, timestampsSupported);
+    objectCache = std::make_unique<GPUObjectCache>(device);
+    shaderManager = std::make_unique<ShaderManager>(device);
 }
 
 
@@ -118,14 +159,50 @@ GPUContext* GPUContext::getInstance(GLFWwindow* window)
         {
             throw std::runtime_error("GPUContext not initialized yet. Please call with a valid GLFWwindow.");
         }
-        ctx = new GPUContext(window);
+        ctx = new GPUContext(window, wgpu::TextureFormat::Undefined, false);
     }
     return ctx;
 }
 
 
-void GPUContext::configSurface(uint32_t width, uint32_t height)
+GPUContext* GPUContext::initHeadless(wgpu::TextureFormat format, bool forceFallbackAdapter)
 {
+    assert(ctx == nullptr && "GPUContext already initialized!");
+    ctx = new GPUContext(nullptr, format, forceFallbackAdapter);
+    return ctx;
+}
+
+
+void GPUContext::configSurface(uint32_t width, uint32_t height, bool vsync)
+{
+    if (isHeadless())
+    {
+        wgpu::TextureDescriptor offscreenDesc = {
+            .label = "Offscreen color texture",
+            .usage = wgpu::TextureUsage::RenderAttachment | wgpu::TextureUsage::CopySrc |
+            wgpu::TextureUsage::TextureBinding,
+            .dimension = wgpu::TextureDimension::e2D,
+            .size = {width, height, 1},
+            .format = surfaceFormat,
+        };
+        offscreenTexture = device.CreateTexture(&offscreenDesc);
+        return;
+    }
+
+    // Fifo is the only mode every surface supports
+    wgpu::PresentMode presentMode = wgpu::PresentMode::Fifo;
+    if (!vsync)
+    {
+        for (const wgpu::PresentMode mode : {wgpu::PresentMode::Immediate, wgpu::PresentMode::Mailbox})
+        {
+            if (std::find(presentModes.begin(), presentModes.end(), mode) != presentModes.end())
+            {
+                presentMode = mode;
+                break;
+            }
+        }
+    }
+
     wgpu::SurfaceConfiguration config = {
         .device = device,
         .format = surfaceFormat,
@@ -133,7 +210,7 @@ void GPUContext::configSurface(uint32_t width, uint32_t height)
         .alphaMode = wgpu::CompositeAlphaMode::Auto,
         .width = width,
         .height = height,
-        .presentMode = wgpu::PresentMode::Fifo,
+        .presentMode = presentMode,
     };
     surface.Configure(&config);
 }
@@ -141,13 +218,19 @@ void GPUContext::configSurface(uint32_t width, uint32_t height)
 
 wgpu::TextureView GPUContext::getNextSurfaceTextureView()
 {
-    wgpu::SurfaceTexture surfaceTexture;
-    surface.GetCurrentTexture(&surfaceTexture);
-
-    if (surfaceTexture.status != wgpu::SurfaceGetCurrentTextureStatus::Success)
+    TRACE_ZONE("GPUContext::getNextSurfaceTextureView");
+    wgpu::Texture texture = offscreenTexture;
+    if (surface)
     {
-        std::cerr << "Failed to get current texture from the surface: " << std::endl;
-        return nullptr;
+        wgpu::SurfaceTexture surfaceTexture;
+        surface.GetCurrentTexture(&surfaceTexture);
+
+        if (surfaceTexture.status != wgpu::SurfaceGetCurrentTextureStatus::Success)
+        {
+            std::cerr << "Failed to get current texture from the surface: " << std::endl;
+            return nullptr;
+        }
+        texture = surfaceTexture.texture;
     }
 
     wgpu::TextureViewDescriptor viewDescriptor = {
@@ -160,5 +243,37 @@ wgpu::TextureView GPUContext::getNextSurfaceTextureView()
         .arrayLayerCount = 1,
         .aspect = wgpu::TextureAspect::All,
     };
-    return surfaceTexture.texture.CreateView(&viewDescriptor);
+    return texture.CreateView(&viewDescriptor);
+}
+
+
+void GPUContext::present()
+{
+    TRACE_ZONE("GPUContext::present");
+    if (surface)
+    {
+        surface.Present();
+        return;
+    }
+
+    // Nothing throttles offscreen frames, let the GPU run at most one frame behind
+    if (previousFrame.id != 0)
+    {
+        instance.WaitAny(previousFrame, UINT64_MAX);
+    }
+    previousFrame = queue.OnSubmittedWorkDone(wgpu::CallbackMode::WaitAnyOnly, [](wgpu::QueueWorkDoneStatus) {});
+}
+
+
+void GPUContext::wait(const wgpu::Future& future)
+{
+    if (future.id != 0) instance.WaitAny(future, UINT64_MAX);
+}
+
+
+void GPUContext::waitIdle()
+{
+    wgpu::Future idleFuture = queue.OnSubmittedWorkDone(wgpu::CallbackMode::WaitAnyOnly,
+                                                        [](wgpu::QueueWorkDoneStatus) {});
+    instance.WaitAny(idleFuture, UINT64_MAX);
 }
@@ -2,6 +2,13 @@
 
 #include <webgpu/webgpu_cpp.h>
 #include <webgpu/webgpu_glfw.h>
+#include <memory>
+#include <vector>
+
+#include "GPUObjectCache.h"
+#include "GPUProfiler.h"
+#include "PipelineCache.h"
+#include "ShaderManager.h"
 
 class GPUContext
 {
@@ -11,21 +18,48 @@ public:
     void operator=(const GPUContext&) = delete;
 
     static GPUContext* getInstance(GLFWwindow* window = nullptr);
+    // Creates the context without a surface, frames are then rendered into an offscreen texture
+    static GPUContext* initHeadless(wgpu::TextureFormat format, bool forceFallbackAdapter = false);
 
-    void configSurface(uint32_t width, uint32_t height);
+    // Configures the surface, or creates the offscreen target in headless mode
+    void configSurface(uint32_t width, uint32_t height, bool vsync = true);
     wgpu::TextureView getNextSurfaceTextureView();
+    void present();
+    // Blocks until all submitted work has completed
+    void waitIdle();
+    // Blocks until the future completes and runs its callback, futures with a null id are ignored
+    void wait(const wgpu::Future& future);
 
     wgpu::Device getDevice() { return device; }
     wgpu::Queue getQueue() { return queue; }
     wgpu::Surface getSurface() { return surface; }
+    bool isHeadless() const { return !surface; }
     wgpu::TextureFormat getSurfaceFormat() { return surfaceFormat; }
+    const wgpu::Limits& getLimits() { return limits; }
+    GPUProfiler& getProfiler() { return *profiler; }
+    GPUObjectCache& getObjectCache() { return *objectCache; }
+    ShaderManager& getShaderManager() { return *shaderManager; }
+    // Runs pending async callbacks such as profiler readbacks
+    void processEvents() { instance.ProcessEvents(); }
 
 protected:
-    explicit GPUContext(GLFWwindow* window);
+    GPUContext(GLFWwindow* window, wgpu::TextureFormat offscreenFormat, bool forceFallbackAdapter);
     static GPUContext* ctx;
+#ifdef GRASS_ENABLE_PIPELINE_CACHE
+    // Must outlive the instance
+    std::unique_ptr<PipelineCachePlatform> pipelineCachePlatform;
+#endif
     wgpu::Instance instance;
     wgpu::Device device;
     wgpu::Queue queue;
     wgpu::Surface surface;
     wgpu::TextureFormat surfaceFormat = wgpu::TextureFormat::Undefined;
+    wgpu::Limits limits;
+    std::vector<wgpu::PresentMode> presentModes;
+    // Headless render target and the last frame, which bounds the frames in flight without a swap chain
+    wgpu::Texture offscreenTexture;
+    wgpu::Future previousFrame{};
+    std::unique_ptr<GPUProfiler> profiler;
+    std::unique_ptr<GPUObjectCache> objectCache;
+    std::unique_ptr<ShaderManager> shaderManager;
 };
@@ -0,0 +1,321 @@
+#include "GPUObjectCache.h"
+
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+
+
+namespace
+{
+    // Serializes descriptor fields one by one, padding bytes never reach the key
+    class KeyBuilder
+    {
+    public:
+        template <typename T>
+        KeyBuilder& add(const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            char bytes[sizeof(T)];
+            std::memcpy(bytes, &value, sizeof(T));
+            key.append(bytes, sizeof(T));
+            return *this;
+        }
+
+        KeyBuilder& addString(const char* value)
+        {
+            const std::string string = value ? value : "";
+            add(string.size());
+            key.append(string);
+            return *this;
+        }
+
+        template <typename T>
+        KeyBuilder& addHandle(const T& object)
+        {
+            return add(static_cast<const void*>(object.Get()));
+        }
+
+        KeyBuilder& addStage(const wgpu::ShaderModule& module, const char* entryPoint, size_t constantCount,
+                             const wgpu::ConstantEntry* constants)
+        {
+            addHandle(module).addString(entryPoint).add(constantCount);
+            for (size_t i = 0; i < constantCount; i++)
+            {
+                addString(constants[i].key).add(constants[i].value);
+            }
+            return *this;
+        }
+
+        KeyBuilder& addBlendComponent(const wgpu::BlendComponent& component)
+        {
+            return add(component.operation).add(component.srcFactor).add(component.dstFactor);
+        }
+
+        KeyBuilder& addStencilFace(const wgpu::StencilFaceState& face)
+        {
+            return add(face.compare).add(face.failOp).add(face.depthFailOp).add(face.passOp);
+        }
+
+        std::string key;
+    };
+
+
+    bool hasChainedStages(const wgpu::RenderPipelineDescriptor& descriptor)
+    {
+        return descriptor.nextInChain || descriptor.vertex.nextInChain || descriptor.primitive.nextInChain ||
+            descriptor.multisample.nextInChain ||
+            (descriptor.depthStencil && descriptor.depthStencil->nextInChain) ||
+            (descriptor.fragment && descriptor.fragment->nextInChain);
+    }
+}
+
+
+wgpu::BindGroupLayout GPUObjectCache::getBindGroupLayout(const wgpu::BindGroupLayoutDescriptor& descriptor)
+{
+    if (descriptor.nextInChain) return device.CreateBindGroupLayout(&descriptor);
+
+    KeyBuilder key;
+    key.add(descriptor.entryCount);
+    for (size_t i = 0; i < descriptor.entryCount; i++)
+    {
+        const wgpu::BindGroupLayoutEntry& entry = descriptor.entries[i];
+        if (entry.nextInChain) return device.CreateBindGroupLayout(&descriptor);
+        key.add(entry.binding).add(entry.visibility)
+           .add(entry.buffer.type).add(entry.buffer.hasDynamicOffset).add(entry.buffer.minBindingSize)
+           .add(entry.sampler.type)
+           .add(entry.texture.sampleType).add(entry.texture.viewDimension).add(entry.texture.multisampled)
+           .add(entry.storageTexture.access).add(entry.storageTexture.format).add(entry.storageTexture.viewDimension);
+    }
+    return getOrCreate(bindGroupLayouts, key.key, [&] { return device.CreateBindGroupLayout(&descriptor); });
+}
+
+
+wgpu::PipelineLayout GPUObjectCache::getPipelineLayout(const wgpu::PipelineLayoutDescriptor& descriptor)
+{
+    if (descriptor.nextInChain) return device.CreatePipelineLayout(&descriptor);
+
+    KeyBuilder key;
+    key.add(descriptor.bindGroupLayoutCount);
+    for (size_t i = 0; i < descriptor.bindGroupLayoutCount; i++)
+    {
+        key.addHandle(descriptor.bindGroupLayouts[i]);
+    }
+    return getOrCreate(pipelineLayouts, key.key, [&]
+    {
+        keyBindGroupLayouts.insert(keyBindGroupLayouts.end(), descriptor.bindGroupLayouts,
+                                   descriptor.bindGroupLayouts + descriptor.bindGroupLayoutCount);
+        return device.CreatePipelineLayout(&descriptor);
+    });
+}
+
+
+wgpu::Sampler GPUObjectCache::getSampler(const wgpu::SamplerDescriptor& descriptor)
+{
+    if (descriptor.nextInChain) return device.CreateSampler(&descriptor);
+
+    KeyBuilder key;
+    key.add(descriptor.addressModeU).add(descriptor.addressModeV).add(descriptor.addressModeW)
+       .add(descriptor.magFilter).add(descriptor.minFilter).add(descriptor.mipmapFilter)
+       .add(descriptor.lodMinClamp).add(descriptor.lodMaxClamp)
+       .add(descriptor.compare).add(descriptor.maxAnisotropy);
+    return getOrCreate(samplers, key.key, [&] { return device.CreateSampler(&descriptor); });
+}
+
+
+bool GPUObjectCache::getRenderPipelineKey(const wgpu::RenderPipelineDescriptor& descriptor, std::string& key)
+{
+    if (hasChainedStages(descriptor)) return false;
+
+    KeyBuilder builder;
+    builder.addHandle(descriptor.layout);
+
+    const wgpu::VertexState& vertex = descriptor.vertex;
+    builder.addStage(vertex.module, vertex.entryPoint, vertex.constantCount, vertex.constants);
+    builder.add(vertex.bufferCount);
+    for (size_t i = 0; i < vertex.bufferCount; i++)
+    {
+        const wgpu::VertexBufferLayout& buffer = vertex.buffers[i];
+        builder.add(buffer.arrayStride).add(buffer.stepMode).add(buffer.attributeCount);
+        for (size_t j = 0; j < buffer.attributeCount; j++)
+        {
+            const wgpu::VertexAttribute& attribute = buffer.attributes[j];
+            builder.add(attribute.format).add(attribute.offset).add(attribute.shaderLocation);
+        }
+    }
+
+    const wgpu::PrimitiveState& primitive = descriptor.primitive;
+    builder.add(primitive.topology).add(primitive.stripIndexFormat).add(primitive.frontFace).add(primitive.cullMode);
+
+    builder.add(descriptor.depthStencil != nullptr);
+    if (const wgpu::DepthStencilState* depthStencil = descriptor.depthStencil)
+    {
+        builder.add(depthStencil->format).add(depthStencil->depthWriteEnabled).add(depthStencil->depthCompare)
+               .addStencilFace(depthStencil->stencilFront).addStencilFace(depthStencil->stencilBack)
+               .add(depthStencil->stencilReadMask).add(depthStencil->stencilWriteMask)
+               .add(depthStencil->depthBias).add(depthStencil->depthBiasSlopeScale)
+               .add(depthStencil->depthBiasClamp);
+    }
+
+    const wgpu::MultisampleState& multisample = descriptor.multisample;
+    builder.add(multisample.count).add(multisample.mask).add(multisample.alphaToCoverageEnabled);
+
+    builder.add(descriptor.fragment != nullptr);
+    if (const wgpu::FragmentState* fragment = descriptor.fragment)
+    {
+        builder.addStage(fragment->module, fragment->entryPoint, fragment->constantCount, fragment->constants);
+        builder.add(fragment->targetCount);
+        for (size_t i = 0; i < fragment->targetCount; i++)
+        {
+            const wgpu::ColorTargetState& target = fragment->targets[i];
+            if (target.nextInChain) return false;
+            builder.add(target.format).add(target.writeMask).add(target.blend != nullptr);
+            if (target.blend)
+            {
+                builder.addBlendComponent(target.blend->color).addBlendComponent(target.blend->alpha);
+            }
+        }
+    }
+    key = std::move(builder.key);
+    return true;
+}
+
+
+bool GPUObjectCache::getComputePipelineKey(const wgpu::ComputePipelineDescriptor& descriptor, std::string& key)
+{
+    if (descriptor.nextInChain || descriptor.compute.nextInChain) return false;
+
+    const wgpu::ProgrammableStageDescriptor& compute = descriptor.compute;
+    KeyBuilder builder;
+    builder.addHandle(descriptor.layout);
+    builder.addStage(compute.module, compute.entryPoint, compute.constantCount, compute.constants);
+    key = std::move(builder.key);
+    return true;
+}
+
+
+void GPUObjectCache::retainKeyHandles(const wgpu::RenderPipelineDescriptor& descriptor)
+{
+    keyPipelineLayouts.push_back(descriptor.layout);
+    keyModules.push_back(descriptor.vertex.module);
+    if (descriptor.fragment) keyModules.push_back(descriptor.fragment->module);
+}
+
+
+void GPUObjectCache::retainKeyHandles(const wgpu::ComputePipelineDescriptor& descriptor)
+{
+    keyPipelineLayouts.push_back(descriptor.layout);
+    keyModules.push_back(descriptor.compute.module);
+}
+
+
+wgpu::RenderPipeline GPUObjectCache::getRenderPipeline(const wgpu::RenderPipelineDescriptor& descriptor)
+{
+    std::string key;
+    if (!getRenderPipelineKey(descriptor, key)) return device.CreateRenderPipeline(&descriptor);
+    return getOrCreate(renderPipelines, key, [&]
+    {
+        retainKeyHandles(descriptor);
+        return device.CreateRenderPipeline(&descriptor);
+    });
+}
+
+
+wgpu::ComputePipeline GPUObjectCache::getComputePipeline(const wgpu::ComputePipelineDescriptor& descriptor)
+{
+    std::string key;
+    if (!getComputePipelineKey(descriptor, key)) return device.CreateComputePipeline(&descriptor);
+    return getOrCreate(computePipelines, key, [&]
+    {
+        retainKeyHandles(descriptor);
+        return device.CreateComputePipeline(&descriptor);
+    });
+}
+
+
+wgpu::Future GPUObjectCache::getRenderPipelineAsync(const wgpu::RenderPipelineDescriptor& descriptor,
+                                                    std::function<void(const wgpu::RenderPipeline&)> callback)
+{
+    std::string key;
+    if (!getRenderPipelineKey(descriptor, key))
+    {
+        callback(device.CreateRenderPipeline(&descriptor));
+        return {};
+    }
+    if (const auto it = renderPipelines.find(key); it != renderPipelines.end())
+    {
+        hits++;
+        callback(it->second);
+        return {};
+    }
+    if (const auto it = pendingRenderPipelines.find(key); it != pendingRenderPipelines.end())
+    {
+        hits++;
+        it->second.callbacks.push_back(std::move(callback));
+        return it->second.future;
+    }
+
+    retainKeyHandles(descriptor);
+    PendingPipeline<wgpu::RenderPipeline>& pending = pendingRenderPipelines[key];
+    pending.callbacks.push_back(std::move(callback));
+    pending.future = device.CreateRenderPipelineAsync(
+        &descriptor, wgpu::CallbackMode::WaitAnyOnly,
+        [this, key, label = std::string(descriptor.label ? descriptor.label : "")](
+        wgpu::CreatePipelineAsyncStatus status, wgpu::RenderPipeline pipeline, const char* message)
+        {
+            if (status != wgpu::CreatePipelineAsyncStatus::Success)
+            {
+                std::cerr << "Could not create " << label << " : " << (message ? message : "") << std::endl;
+                pipeline = nullptr;
+            }
+            completePending(renderPipelines, pendingRenderPipelines, key, pipeline);
+        });
+    return pending.future;
+}
+
+
+wgpu::Future GPUObjectCache::getComputePipelineAsync(const wgpu::ComputePipelineDescriptor& descriptor,
+                                                     std::function<void(const wgpu::ComputePipeline&)> callback)
+{
+    std::string key;
+    if (!getComputePipelineKey(descriptor, key))
+    {
+        callback(device.CreateComputePipeline(&descriptor));
+        return {};
+    }
+    if (const auto it = computePipelines.find(key); it != computePipelines.end())
+    {
+        hits++;
+        callback(it->second);
+        return {};
+    }
+    if (const auto it = pendingComputePipelines.find(key); it != pendingComputePipelines.end())
+    {
+        hits++;
+        it->second.callbacks.push_back(std::move(callback));
+        return it->second.future;
+    }
+
+    retainKeyHandles(descriptor);
+    PendingPipeline<wgpu::ComputePipeline>& pending = pendingComputePipelines[key];
+    pending.callbacks.push_back(std::move(callback));
+    pending.future = device.CreateComputePipelineAsync(
+        &descriptor, wgpu::CallbackMode::WaitAnyOnly,
+        [this, key, label = std::string(descriptor.label ? descriptor.label : "")](
+        wgpu::CreatePipelineAsyncStatus status, wgpu::ComputePipeline pipeline, const char* message)
+        {
+            if (status != wgpu::CreatePipelineAsyncStatus::Success)
+            {
+                std::cerr << "Could not create " << label << " : " << (message ? message : "") << std::endl;
+                pipeline = nullptr;
+            }
+            completePending(computePipelines, pendingComputePipelines, key, pipeline);
+        });
+    return pending.future;
+}
+
+
+size_t GPUObjectCache::getObjectCount() const
+{
+    return bindGroupLayouts.size() + pipelineLayouts.size() + samplers.size() + renderPipelines.size() +
+        computePipelines.size();
+}
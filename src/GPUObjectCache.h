@@ -0,0 +1,91 @@
+#pragma once
+
+#include <webgpu/webgpu_cpp.h>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Device objects shared by every identical descriptor, keyed by descriptor content.
+// Labels are not part of the key, an object keeps the label of the first descriptor that created it.
+// Descriptors with chained structs can't be keyed and always create a new object.
+class GPUObjectCache
+{
+public:
+    explicit GPUObjectCache(const wgpu::Device& device) : device(device) {}
+
+    wgpu::BindGroupLayout getBindGroupLayout(const wgpu::BindGroupLayoutDescriptor& descriptor);
+    // Layouts are compared by handle, so bind group layouts should come from the cache as well
+    wgpu::PipelineLayout getPipelineLayout(const wgpu::PipelineLayoutDescriptor& descriptor);
+    wgpu::Sampler getSampler(const wgpu::SamplerDescriptor& descriptor);
+    // Shader modules and layouts are compared by handle
+    wgpu::RenderPipeline getRenderPipeline(const wgpu::RenderPipelineDescriptor& descriptor);
+    wgpu::ComputePipeline getComputePipeline(const wgpu::ComputePipelineDescriptor& descriptor);
+
+    // Compiled on Dawn's worker threads, the callback runs when the returned future is waited on with
+    // GPUContext::wait, with a null pipeline if the creation failed. Cached pipelines call back right away and
+    // return a null future, identical requests in flight share one creation.
+    wgpu::Future getRenderPipelineAsync(const wgpu::RenderPipelineDescriptor& descriptor,
+                                        std::function<void(const wgpu::RenderPipeline&)> callback);
+    wgpu::Future getComputePipelineAsync(const wgpu::ComputePipelineDescriptor& descriptor,
+                                         std::function<void(const wgpu::ComputePipeline&)> callback);
+
+    [[nodiscard]] size_t getHitCount() const { return hits; }
+    [[nodiscard]] size_t getObjectCount() const;
+
+private:
+    template <typename T>
+    struct PendingPipeline
+    {
+        wgpu::Future future;
+        std::vector<std::function<void(const T&)>> callbacks;
+    };
+
+    // False when the descriptor can't be keyed
+    static bool getRenderPipelineKey(const wgpu::RenderPipelineDescriptor& descriptor, std::string& key);
+    static bool getComputePipelineKey(const wgpu::ComputePipelineDescriptor& descriptor, std::string& key);
+    void retainKeyHandles(const wgpu::RenderPipelineDescriptor& descriptor);
+    void retainKeyHandles(const wgpu::ComputePipelineDescriptor& descriptor);
+
+    template <typename T>
+    void completePending(std::unordered_map<std::string, T>& objects,
+                         std::unordered_map<std::string, PendingPipeline<T>>& pending, const std::string& key,
+                         const T& pipeline)
+    {
+        const auto it = pending.find(key);
+        if (it == pending.end()) return;
+        const PendingPipeline<T> completed = std::move(it->second);
+        pending.erase(it);
+        if (pipeline) objects.emplace(key, pipeline);
+        for (const auto& callback : completed.callbacks) callback(pipeline);
+    }
+
+    template <typename T>
+    T getOrCreate(std::unordered_map<std::string, T>& objects, const std::string& key, auto create)
+    {
+        if (const auto it = objects.find(key); it != objects.end())
+        {
+            hits++;
+            return it->second;
+        }
+        T object = create();
+        if (object) objects.emplace(key, object);
+        return object;
+    }
+
+    wgpu::Device device;
+    size_t hits = 0;
+
+    std::unordered_map<std::string, wgpu::BindGroupLayout> bindGroupLayouts;
+    std::unordered_map<std::string, wgpu::PipelineLayout> pipelineLayouts;
+    std::unordered_map<std::string, wgpu::Sampler> samplers;
+    std::unordered_map<std::string, wgpu::RenderPipeline> renderPipelines;
+    std::unordered_map<std::string, wgpu::ComputePipeline> computePipelines;
+    std::unordered_map<std::string, PendingPipeline<wgpu::RenderPipeline>> pendingRenderPipelines;
+    std::unordered_map<std::string, PendingPipeline<wgpu::ComputePipeline>> pendingComputePipelines;
+
+    // Handles used in keys are kept alive, so a released address can't be reused by a different object
+    std::vector<wgpu::BindGroupLayout> keyBindGroupLayouts;
+    std::vector<wgpu::PipelineLayout> keyPipelineLayouts;
+    std::vector<wgpu::ShaderModule> keyModules;
+};
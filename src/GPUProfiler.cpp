@@ -0,0 +1,169 @@
+#include "GPUProfiler.h"
+
+#include <algorithm>
+#include <iostream>
+
+
+GPUProfiler::GPUProfiler(const wgpu::Device& device, bool timestampsSupported)
+    : device(device), enabled(timestampsSupported)
+{
+    if (!enabled) return;
+
+    wgpu::QuerySetDescriptor querySetDesc = {
+        .label = "Profiler timestamp query set",
+        .type = wgpu::QueryType::Timestamp,
+        .count = 2 * MAX_PASSES_PER_FRAME
+    };
+    querySet = device.CreateQuerySet(&querySetDesc);
+
+    wgpu::BufferDescriptor resolveBufferDesc = {
+        .label = "Profiler resolve buffer",
+        .usage = wgpu::BufferUsage::QueryResolve | wgpu::BufferUsage::CopySrc,
+        .size = 2 * MAX_PASSES_PER_FRAME * sizeof(uint64_t),
+        .mappedAtCreation = false
+    };
+    resolveBuffer = device.CreateBuffer(&resolveBufferDesc);
+
+    // Several frames can be read back at once so the CPU never waits on the GPU
+    for (Readback& readback : readbacks)
+    {
+        wgpu::BufferDescriptor readbackBufferDesc = {
+            .label = "Profiler readback buffer",
+            .usage = wgpu::BufferUsage::MapRead | wgpu::BufferUsage::CopyDst,
+            .size = resolveBuffer.GetSize(),
+            .mappedAtCreation = false
+        };
+        readback.buffer = device.CreateBuffer(&readbackBufferDesc);
+    }
+
+    for (uint32_t i = 0; i < MAX_PASSES_PER_FRAME; i++)
+    {
+        computeWrites[i] = {.querySet = querySet, .beginningOfPassWriteIndex = 2 * i, .endOfPassWriteIndex = 2 * i + 1};
+        renderWrites[i] = {.querySet = querySet, .beginningOfPassWriteIndex = 2 * i, .endOfPassWriteIndex = 2 * i + 1};
+    }
+
+    enabled = querySet != nullptr && resolveBuffer != nullptr;
+    if (!enabled)
+    {
+        std::cerr << "Could not create the profiler resources, GPU timings are disabled" << std::endl;
+    }
+}
+
+
+void GPUProfiler::beginFrame()
+{
+    framePassNames.clear();
+}
+
+
+int32_t GPUProfiler::beginPass(const std::string& name)
+{
+    if (!enabled || framePassNames.size() >= MAX_PASSES_PER_FRAME) return -1;
+    framePassNames.push_back(name);
+    return static_cast<int32_t>(framePassNames.size() - 1);
+}
+
+
+const wgpu::ComputePassTimestampWrites* GPUProfiler::computePass(const std::string& name)
+{
+    const int32_t passIndex = beginPass(name);
+    return passIndex < 0 ? nullptr : &computeWrites[passIndex];
+}
+
+
+const wgpu::RenderPassTimestampWrites* GPUProfiler::renderPass(const std::string& name)
+{
+    const int32_t passIndex = beginPass(name);
+    return passIndex < 0 ? nullptr : &renderWrites[passIndex];
+}
+
+
+void GPUProfiler::resolve(const wgpu::CommandEncoder& encoder)
+{
+    if (!enabled || framePassNames.empty()) return;
+
+    // Every readback is still waiting on the GPU, drop this frame rather than stall
+    Readback& readback = readbacks[nextReadback];
+    if (readback.inFlight) return;
+
+    const auto queryCount = static_cast<uint32_t>(2 * framePassNames.size());
+    encoder.ResolveQuerySet(querySet, 0, queryCount, resolveBuffer, 0);
+    encoder.CopyBufferToBuffer(resolveBuffer, 0, readback.buffer, 0, queryCount * sizeof(uint64_t));
+
+    readback.passNames = framePassNames;
+    readback.inFlight = true;
+    resolvedReadback = &readback;
+    nextReadback = (nextReadback + 1) % READBACK_COUNT;
+}
+
+
+void GPUProfiler::endFrame()
+{
+    if (resolvedReadback == nullptr) return;
+
+    Readback& readback = *resolvedReadback;
+    resolvedReadback = nullptr;
+    const auto queryCount = static_cast<uint32_t>(2 * readback.passNames.size());
+    readback.buffer.MapAsync(
+        wgpu::MapMode::Read, 0, queryCount * sizeof(uint64_t),
+        wgpu::CallbackMode::AllowProcessEvents,
+        [this, &readback](wgpu::MapAsyncStatus status, const char* message)
+        {
+            if (status == wgpu::MapAsyncStatus::Success)
+            {
+                readTimestamps(readback);
+            }
+            readback.buffer.Unmap();
+            readback.inFlight = false;
+        }
+    );
+}
+
+
+void GPUProfiler::reset()
+{
+    histories.clear();
+    timings.clear();
+}
+
+
+void GPUProfiler::readTimestamps(Readback& readback)
+{
+    const auto* timestamps = static_cast<const uint64_t*>(readback.buffer.GetConstMappedRange(
+        0, 2 * readback.passNames.size() * sizeof(uint64_t)));
+    if (timestamps == nullptr) return;
+
+    for (size_t i = 0; i < readback.passNames.size(); i++)
+    {
+        const uint64_t begin = timestamps[2 * i];
+        const uint64_t end = timestamps[2 * i + 1];
+        // Timestamps can go backwards when the GPU changes its clock, skip those samples
+        if (end < begin) continue;
+        addSample(readback.passNames[i], static_cast<float>(end - begin) * 1e-6f);
+    }
+}
+
+
+void GPUProfiler::addSample(const std::string& name, float durationMs)
+{
+    auto it = std::find_if(timings.begin(), timings.end(),
+                           [&name](const PassTiming& timing) { return timing.name == name; });
+    if (it == timings.end())
+    {
+        timings.push_back({.name = name});
+        histories.emplace_back();
+        it = timings.end() - 1;
+    }
+
+    PassHistory& history = histories[it - timings.begin()];
+    history.samples[history.cursor] = durationMs;
+    history.cursor = (history.cursor + 1) % HISTORY_LENGTH;
+    history.count = std::min(history.count + 1, HISTORY_LENGTH);
+
+    const auto samplesEnd = history.samples.begin() + history.count;
+    float sum = 0.0;
+    for (auto sample = history.samples.begin(); sample != samplesEnd; ++sample) sum += *sample;
+    it->minMs = *std::min_element(history.samples.begin(), samplesEnd);
+    it->maxMs = *std::max_element(history.samples.begin(), samplesEnd);
+    it->avgMs = sum / static_cast<float>(history.count);
+}
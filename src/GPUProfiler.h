@@ -0,0 +1,75 @@
+#pragma once
+
+#include <webgpu/webgpu_cpp.h>
+#include <array>
+#include <string>
+#include <vector>
+
+// Rolling GPU timings per pass, measured with timestamp queries
+class GPUProfiler
+{
+    static constexpr uint32_t MAX_PASSES_PER_FRAME = 16;
+    static constexpr uint32_t READBACK_COUNT = 3;
+    static constexpr uint32_t HISTORY_LENGTH = 120;
+
+public:
+    struct PassTiming
+    {
+        std::string name;
+        float minMs = 0.0;
+        float avgMs = 0.0;
+        float maxMs = 0.0;
+    };
+
+    GPUProfiler(const wgpu::Device& device, bool timestampsSupported);
+
+    void beginFrame();
+    // Null when timestamps are not supported or the frame ran out of queries, passes then run unprofiled
+    const wgpu::ComputePassTimestampWrites* computePass(const std::string& name);
+    const wgpu::RenderPassTimestampWrites* renderPass(const std::string& name);
+    // Copies the frame timestamps into a free readback buffer, at the end of the frame's encoder
+    void resolve(const wgpu::CommandEncoder& encoder);
+    // Maps the resolved readback, once the encoder has been submitted
+    void endFrame();
+    // Forgets the collected timings, e.g. between benchmark scenarios
+    void reset();
+
+    [[nodiscard]] bool isEnabled() const { return enabled; }
+    [[nodiscard]] const std::vector<PassTiming>& getTimings() const { return timings; }
+
+private:
+    struct Readback
+    {
+        wgpu::Buffer buffer;
+        std::vector<std::string> passNames;
+        bool inFlight = false;
+    };
+
+    struct PassHistory
+    {
+        std::array<float, HISTORY_LENGTH> samples{};
+        uint32_t count = 0;
+        uint32_t cursor = 0;
+    };
+
+    int32_t beginPass(const std::string& name);
+    void readTimestamps(Readback& readback);
+    void addSample(const std::string& name, float durationMs);
+
+    wgpu::Device device;
+    bool enabled = false;
+
+    wgpu::QuerySet querySet;
+    wgpu::Buffer resolveBuffer;
+    std::array<Readback, READBACK_COUNT> readbacks;
+    uint32_t nextReadback = 0;
+    Readback* resolvedReadback = nullptr;
+
+    std::vector<std::string> framePassNames;
+    std::array<wgpu::ComputePassTimestampWrites, MAX_PASSES_PER_FRAME> computeWrites;
+    std::array<wgpu::RenderPassTimestampWrites, MAX_PASSES_PER_FRAME> renderWrites;
+
+    // Same order in both, by first appearance
+    std::vector<PassHistory> histories;
+    std::vector<PassTiming> timings;
+};
@@ -1,9 +1,22 @@
 #pragma once
 
+#include <string>
+#include <webgpu/webgpu_cpp.h>
+
 #include "uniforms.h"
 
 namespace grass
 {
+    // Blade meshes from the most to the least detailed, see Renderer::bladeLodGeometries
+    inline constexpr uint32_t BLADE_LOD_COUNT = 3;
+
+    // How blade compute passes map invocations to blades
+    enum class DispatchMode
+    {
+        Linear, // 1D workgroups folded into a 2D grid, no per-side limit
+        Tiled, // 2D workgroups tiling the blade grid
+    };
+
     struct GlobalConfig
     {
         GlobalConfig() { calculateTotal(); }
@@ -13,14 +26,81 @@ namespace grass
             bladesPerSide = static_cast<size_t>(grassUniform.sideLength * grassUniform.density * 2);
             totalBlades = static_cast<size_t>(std::floor(std::pow(bladesPerSide, 2)));
             grassUniform.maxNoisePositionOffset = grassUniform.sideLength / static_cast<float>(bladesPerSide);
+            grassUniform.terrainOrigin = glm::vec2(-grassUniform.sideLength);
+            grassUniform.terrainSize = 2.0f * grassUniform.sideLength;
+            chunksPerSide = (bladesPerSide + chunkBladesPerSide - 1) / chunkBladesPerSide;
+            chunkCount = chunksPerSide * chunksPerSide;
+            // Every chunk gets a full range so border chunks keep the same blade indexing
+            bladeCapacity = chunkCount * chunkBladesPerSide * chunkBladesPerSide;
         }
 
+        // Streamed chunks are always full, the ring holds more blades than the fixed field
+        [[nodiscard]] size_t getBladeCount() const { return infiniteTerrain ? bladeCapacity : totalBlades; }
+
         GrassGenUniformData grassUniform{};
         GrassMovUniformData movUniform{};
+        CullUniformData cullUniform{};
         BladeStaticUniformData bladeUniform{};
         LightUniformData lightUniform{};
         ScreenSpaceShadowsUniformData shadowUniform{};
         size_t bladesPerSide{};
         size_t totalBlades{};
+
+        // Chunks are the unit of CPU culling, each one is generated, moved and culled by its own dispatch
+        size_t chunkBladesPerSide = 64;
+        size_t chunksPerSide{};
+        size_t chunkCount{};
+        size_t bladeCapacity{};
+        // Chunks follow the camera in a toroidal ring instead of covering a fixed field, selected at init
+        bool infiniteTerrain = false;
+        // Chunks receiving a height update per frame, 0 updates the whole field in one frame
+        uint32_t heightUpdateChunksPerFrame = 0;
+        // Visible chunks past each distance are moved every 2nd, 4th then 8th frame and hold their pose in between,
+        // the fog hides most of the difference
+        bool amortizedMovement = true;
+        glm::vec3 movementIntervalDistances = {14.0f, 20.0f, 26.0f};
+
+        // Heightmap sampled by generation, baked from procedural noise when no file is given.
+        // The heightmap covers the field and repeats with infinite terrain.
+        std::string terrainHeightmapPath;
+        float terrainHeightmapScale = 2.0f; // world height of a white texel
+        uint32_t terrainResolution = 512; // baked heightmap only
+
+        // Wind noise texture centered on the camera, stretched over the culling distance every frame
+        uint32_t windFieldResolution = 768;
+
+        // Colliders are binned in a grid covering the culling distance around the camera, selected at init
+        uint32_t maxColliders = 1024;
+        uint32_t colliderGridCellsPerSide = 64;
+        uint32_t maxCellColliders = 16;
+        // Sphere following the camera, 0 disables it
+        float cameraColliderRadius = 0.3f;
+
+        // Trample map stamped by the colliders, stretched over the culling distance around the camera every frame.
+        // 1024 texels over the default 70 m are about the blade spacing.
+        // Trails fade with the recovery time constant in seconds, 0 removes them on the next frame.
+        uint32_t trampleResolution = 1024;
+        float trampleRecoveryTime = 4.0f;
+
+        // Baked into the compute pipelines as override constants
+        DispatchMode dispatchMode = DispatchMode::Linear;
+        uint32_t linearWorkgroupSize = 64;
+        glm::uvec2 tiledWorkgroupSize = {8, 8};
+
+        // Quantized blade storage (32 instead of 80 bytes per blade), selects the blade layout shader at init
+        bool packedBlades = false;
+        // 4x MSAA, selects the shadow depth shader at init
+        bool multiSample = true;
+
+        // Windowed mode waits for the display refresh, otherwise presents with Mailbox or Immediate
+        bool vsync = true;
+        // Renders headlessFrameCount frames into an offscreen texture without a window, GUI or input, then exits
+        bool headless = false;
+        uint32_t headlessFrameCount = 1000;
+        glm::uvec2 headlessSize = {1600, 900};
+        // Matches the format of the screen-space shadow storage texture
+        wgpu::TextureFormat headlessFormat = wgpu::TextureFormat::RGBA8Unorm;
+        // Asks for Dawn's CPU adapter (SwiftShader), e.g. on CI machines without a GPU
+        bool forceFallbackAdapter = false;
     };
 }
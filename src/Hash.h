@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// FNV-1a, stable between runs and platforms unlike std::hash, for keys stored on disk
+inline uint64_t hashBytes(const void* data, size_t size, uint64_t hash = 14695981039346656037ull)
+{
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
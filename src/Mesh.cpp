@@ -1,90 +1,89 @@
 #include "Mesh.h"
 
+#include <cstring>
+#include <iostream>
+
 #include "GPUContext.h"
-#include "layouts.h"
+#include "MeshFile.h"
 #include "Utils.h"
 
 namespace grass
 {
+    namespace
+    {
+        // Filled from the file mapping through the buffer mapping, without a staging copy
+        wgpu::Buffer createMappedBuffer(const std::string& label, wgpu::BufferUsage usage, const void* data,
+                                        size_t size)
+        {
+            wgpu::BufferDescriptor bufferDesc{
+                .label = label.c_str(),
+                .usage = usage,
+                .size = (size + 3) & ~size_t{3},
+                .mappedAtCreation = true,
+            };
+            wgpu::Buffer buffer = GPUContext::getInstance()->getDevice().CreateBuffer(&bufferDesc);
+            std::memcpy(buffer.GetMappedRange(), data, size);
+            buffer.Unmap();
+            return buffer;
+        }
+    }
+
+
     MeshGeomoetry::MeshGeomoetry(const std::string& meshFilePath)
+        : MeshGeomoetry(meshFilePath, MeshFile::import(meshFilePath))
+    {
+    }
+
+
+    MeshGeomoetry::MeshGeomoetry(const std::string& label, const MeshFile& meshFile)
     {
-        createVertexBuffer(meshFilePath);
+        createBuffers(label, meshFile);
     }
 
 
-    void MeshGeomoetry::createVertexBuffer(const std::string& meshFilePath)
+    void MeshGeomoetry::createBuffers(const std::string& meshLabel, const MeshFile& meshFile)
     {
-        std::vector<VertexData> verticesData;
-        if (!loadVertexData(meshFilePath, verticesData))
+        if (!meshFile.isValid() || meshFile.getIndices().empty())
         {
-            std::cerr << "Could not load geometry!" << std::endl;
+            std::cerr << "Could not load mesh " << meshLabel << std::endl;
+            return;
         }
 
-        vertexCount = verticesData.size();
-        std::string label = "Vertex buffer :" + meshFilePath;
-        wgpu::BufferDescriptor bufferDesc{
-            .label = label.c_str(),
-            .usage = wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::Vertex,
-            .size = verticesData.size() * sizeof(VertexData),
-            .mappedAtCreation = false,
-        };
-        vertexBuffer = GPUContext::getInstance()->getDevice().CreateBuffer(&bufferDesc);
-        GPUContext::getInstance()->getQueue().WriteBuffer(vertexBuffer, 0, verticesData.data(), bufferDesc.size);
+        const std::span<const VertexData> vertices = meshFile.getVertices();
+        const std::span<const uint32_t> indices = meshFile.getIndices();
+        indexCount = static_cast<uint32_t>(indices.size());
+        vertexBuffer = createMappedBuffer("Vertex buffer :" + meshLabel, wgpu::BufferUsage::Vertex, vertices.data(),
+                                          vertices.size_bytes());
+        indexBuffer = createMappedBuffer("Index buffer :" + meshLabel, wgpu::BufferUsage::Index, indices.data(),
+                                         indices.size_bytes());
     }
 
-    void MeshGeomoetry::draw(const wgpu::RenderPassEncoder& pass, uint32_t instanceCount)
+    void MeshGeomoetry::draw(const wgpu::RenderPassEncoder& pass, uint32_t instanceCount,
+                             uint32_t firstInstance) const
     {
+        if (!indexBuffer) return;
         pass.SetVertexBuffer(0, vertexBuffer, 0, vertexBuffer.GetSize());
-        pass.Draw(vertexCount, instanceCount, 0, 0);
-    }
-
-    Mesh::Mesh(MeshGeomoetry geometry, PhongMaterial material) : geometry(std::move(geometry)),
-                                                                 material(std::move(material))
-    {
-        createBuffer();
-        createBindGroup();
+        pass.SetIndexBuffer(indexBuffer, wgpu::IndexFormat::Uint32, 0, indexBuffer.GetSize());
+        pass.DrawIndexed(indexCount, instanceCount, 0, 0, firstInstance);
     }
 
-    void Mesh::createBuffer()
+    void MeshGeomoetry::drawIndirect(const wgpu::RenderPassEncoder& pass, const wgpu::Buffer& indirectBuffer,
+                                     uint64_t offset)
     {
-        wgpu::BufferDescriptor bufferDesc = {
-            .label = "Model uniform buffer",
-            .usage = wgpu::BufferUsage::Uniform | wgpu::BufferUsage::CopyDst,
-            .size = sizeof(glm::mat4),
-            .mappedAtCreation = false
-        };
-        modelBuffer = GPUContext::getInstance()->getDevice().CreateBuffer(&bufferDesc);
+        if (!indexBuffer) return;
+        pass.SetVertexBuffer(0, vertexBuffer, 0, vertexBuffer.GetSize());
+        pass.SetIndexBuffer(indexBuffer, wgpu::IndexFormat::Uint32, 0, indexBuffer.GetSize());
+        pass.DrawIndexedIndirect(indirectBuffer, offset);
     }
 
-
-    void Mesh::createBindGroup()
+    Mesh::Mesh(MeshGeomoetry geometry, PhongMaterial material) : geometry(std::move(geometry)),
+                                                                 material(std::move(material))
     {
-        wgpu::BindGroupEntry entry[1] = {
-            {
-                .binding = 0,
-                .buffer = modelBuffer,
-                .offset = 0,
-                .size = modelBuffer.GetSize()
-            },
-        };
-        wgpu::BindGroupDescriptor bindGroupDesc = {
-            .label = "Model bind group",
-            .layout = GPUContext::getInstance()->getDevice().CreateBindGroupLayout(&modelBindGroupLayoutDesc),
-            .entryCount = 1,
-            .entries = &entry[0]
-        };
-        bindGroup = GPUContext::getInstance()->getDevice().CreateBindGroup(&bindGroupDesc);
     }
 
 
-    void Mesh::draw(const wgpu::RenderPassEncoder& pass, uint32_t instanceCount)
+    void Mesh::draw(const wgpu::RenderPassEncoder& pass, uint32_t instanceCount) const
     {
-        GPUContext::getInstance()->getQueue().WriteBuffer(
-            modelBuffer,
-            0,
-            &model,
-            modelBuffer.GetSize()
-        );
         geometry.draw(pass, instanceCount);
     }
 } // grass
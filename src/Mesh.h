@@ -2,22 +2,45 @@
 
 #include <webgpu/webgpu_cpp.h>
 #include <glm/glm.hpp>
+#include <string>
+#include <vector>
 
 #include "PhongMaterial.h"
 
 namespace grass
 {
+    class MeshFile;
+
+
+    // Pushes the grass, in mesh space. A sphere when a and b are equal, a capsule around the segment otherwise.
+    struct MeshCollider
+    {
+        glm::vec3 a;
+        glm::vec3 b;
+        float radius;
+    };
+
+
     class MeshGeomoetry
     {
     public:
+        MeshGeomoetry() = default;
         explicit MeshGeomoetry(const std::string& meshFilePath);
-        void draw(const wgpu::RenderPassEncoder& pass, uint32_t instanceCount);
+        // Mesh already imported, e.g. on a StartupScheduler thread
+        MeshGeomoetry(const std::string& label, const MeshFile& meshFile);
+        void draw(const wgpu::RenderPassEncoder& pass, uint32_t instanceCount, uint32_t firstInstance = 0) const;
+        // Reads DrawIndexedIndirectArgs at offset
+        void drawIndirect(const wgpu::RenderPassEncoder& pass, const wgpu::Buffer& indirectBuffer, uint64_t offset);
+        uint32_t getIndexCount() const { return indexCount; }
+        // Same for the copies of a geometry, which share their buffers
+        const void* getKey() const { return vertexBuffer.Get(); }
 
     private:
-        void createVertexBuffer(const std::string& meshFilePath);
+        void createBuffers(const std::string& meshLabel, const MeshFile& meshFile);
 
         wgpu::Buffer vertexBuffer;
-        size_t vertexCount = 0;
+        wgpu::Buffer indexBuffer;
+        uint32_t indexCount = 0;
     };
 
 
@@ -25,17 +48,13 @@ namespace grass
     {
     public:
         Mesh(MeshGeomoetry geometry, PhongMaterial material);
-        void draw(const wgpu::RenderPassEncoder& pass, uint32_t instanceCount);
+        void draw(const wgpu::RenderPassEncoder& pass, uint32_t instanceCount) const;
 
         MeshGeomoetry geometry;
         PhongMaterial material;
+        // Packed with the other instances of its batch by the Renderer every frame
         glm::mat4 model = glm::mat4(1.0f);
-
-        wgpu::Buffer modelBuffer;
-        wgpu::BindGroup bindGroup;
-
-    private:
-        void createBindGroup();
-        void createBuffer();
+        // Moved with the model by ComputeManager::updateColliders
+        std::vector<MeshCollider> colliders;
     };
 } // grass
@@ -0,0 +1,282 @@
+#include "MeshFile.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "GPUContext.h"
+#include "Hash.h"
+#include "MeshOptimizer.h"
+#include "Tracer.h"
+#include "Utils.h"
+
+namespace grass
+{
+    // Relative to the working directory, like the shader and asset paths
+    constexpr auto MESH_CACHE_DIR = "mesh_cache";
+
+    static_assert(sizeof(VertexData) == 8 * sizeof(float), "VertexData is stored and uploaded as is");
+    static_assert(sizeof(MeshFileHeader) % 4 == 0);
+
+
+    namespace
+    {
+        // One file per source path, named after the OBJ to stay readable
+        std::string getCachePath(const std::string& objPath)
+        {
+            const std::filesystem::path source(objPath);
+            const std::string absolutePath = std::filesystem::absolute(source).lexically_normal().generic_string();
+            std::ostringstream name;
+            name << source.stem().string() << "-" << std::hex << hashBytes(absolutePath.data(), absolutePath.size())
+                << ".gmesh";
+            return (std::filesystem::path(MESH_CACHE_DIR) / name.str()).string();
+        }
+
+
+        // Indexes and optimizes the OBJ corners, then lays out the whole file
+        std::vector<uint8_t> buildMeshFile(const std::vector<VertexData>& corners, MeshFileHeader header)
+        {
+            std::vector<VertexData> vertices;
+            std::vector<uint32_t> indices;
+            deduplicateVertices(corners, vertices, indices);
+            indices = optimizeVertexCache(indices, vertices.size());
+            optimizeVertexFetch(vertices, indices);
+
+            header.vertexCount = static_cast<uint32_t>(vertices.size());
+            header.indexCount = static_cast<uint32_t>(indices.size());
+            header.vertexOffset = sizeof(MeshFileHeader);
+            header.indexOffset = header.vertexOffset + vertices.size() * sizeof(VertexData);
+            header.boundsMin = glm::vec3(std::numeric_limits<float>::max());
+            header.boundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+            for (const VertexData& vertex : vertices)
+            {
+                header.boundsMin = glm::min(header.boundsMin, vertex.position);
+                header.boundsMax = glm::max(header.boundsMax, vertex.position);
+            }
+
+            std::vector<uint8_t> image(header.indexOffset + indices.size() * sizeof(uint32_t));
+            std::memcpy(image.data(), &header, sizeof(MeshFileHeader));
+            std::memcpy(image.data() + header.vertexOffset, vertices.data(), vertices.size() * sizeof(VertexData));
+            std::memcpy(image.data() + header.indexOffset, indices.data(), indices.size() * sizeof(uint32_t));
+            return image;
+        }
+
+
+        // Written aside then renamed, a concurrent run never maps a partial file
+        bool writeFile(const std::string& path, const std::vector<uint8_t>& image)
+        {
+            std::error_code error;
+            std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+            const std::string tmpPath = path + ".tmp";
+            {
+                std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+                file.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()));
+                if (!file.good()) return false;
+            }
+            std::filesystem::rename(tmpPath, path, error);
+            return !error;
+        }
+
+
+        void updateSourceTime(const std::string& path, int64_t sourceTime)
+        {
+            std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(offsetof(MeshFileHeader, sourceTime));
+            file.write(reinterpret_cast<const char*>(&sourceTime), sizeof(sourceTime));
+        }
+    }
+
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+    {
+        if (this == &other) return *this;
+        close();
+        bytes = std::exchange(other.bytes, nullptr);
+        byteCount = std::exchange(other.byteCount, 0);
+#ifdef _WIN32
+        fileHandle = std::exchange(other.fileHandle, nullptr);
+        mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#endif
+        return *this;
+    }
+
+
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+
+    bool MappedFile::open(const std::string& path)
+    {
+        close();
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+        {
+            CloseHandle(file);
+            return false;
+        }
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (view == nullptr)
+        {
+            if (mapping) CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+        fileHandle = file;
+        mappingHandle = mapping;
+        bytes = static_cast<const uint8_t*>(view);
+        byteCount = static_cast<size_t>(fileSize.QuadPart);
+#else
+        const int file = ::open(path.c_str(), O_RDONLY);
+        if (file < 0) return false;
+        struct stat status{};
+        if (fstat(file, &status) != 0 || status.st_size == 0)
+        {
+            ::close(file);
+            return false;
+        }
+        void* view = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        // The mapping keeps the file referenced
+        ::close(file);
+        if (view == MAP_FAILED) return false;
+        bytes = static_cast<const uint8_t*>(view);
+        byteCount = static_cast<size_t>(status.st_size);
+#endif
+        return true;
+    }
+
+
+    void MappedFile::close()
+    {
+        if (bytes == nullptr) return;
+#ifdef _WIN32
+        UnmapViewOfFile(bytes);
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        fileHandle = nullptr;
+        mappingHandle = nullptr;
+#else
+        munmap(const_cast<uint8_t*>(bytes), byteCount);
+#endif
+        bytes = nullptr;
+        byteCount = 0;
+    }
+
+
+    MeshFile MeshFile::import(const std::string& objPath)
+    {
+        TRACE_ZONE("MeshFile::import");
+        std::error_code error;
+        const uint64_t sourceSize = std::filesystem::file_size(objPath, error);
+        if (error)
+        {
+            std::cerr << "Could not read mesh " << objPath << " : " << error.message() << std::endl;
+            return {};
+        }
+        const int64_t sourceTime = std::filesystem::last_write_time(objPath, error).time_since_epoch().count();
+
+        const std::string cachePath = getCachePath(objPath);
+        MeshFile cached = open(cachePath);
+        const bool sameSize = cached.isValid() && cached.header->sourceSize == sourceSize;
+        if (sameSize && cached.header->sourceTime == sourceTime) return cached;
+
+        // Timestamps also change on checkouts and copies, the content decides
+        std::ifstream source(objPath, std::ios::binary);
+        const std::string sourceBytes{std::istreambuf_iterator<char>(source), std::istreambuf_iterator<char>()};
+        const uint64_t sourceHash = hashBytes(sourceBytes.data(), sourceBytes.size());
+        if (sameSize && cached.header->sourceHash == sourceHash)
+        {
+            cached = {};
+            updateSourceTime(cachePath, sourceTime);
+            return open(cachePath);
+        }
+
+        const std::vector<VertexData> corners = loadVertexData(objPath);
+        if (corners.empty()) return {};
+        std::vector<uint8_t> image = buildMeshFile(corners, {
+                                               .sourceSize = sourceSize,
+                                               .sourceTime = sourceTime,
+                                               .sourceHash = sourceHash,
+                                               });
+        cached = {};
+        if (writeFile(cachePath, image))
+        {
+            MeshFile written = open(cachePath);
+            if (written.isValid()) return written;
+        }
+
+        std::cerr << "Could not write the mesh cache " << cachePath << ", " << objPath << " is imported every run"
+            << std::endl;
+        MeshFile mesh;
+        mesh.memory = std::move(image);
+        mesh.setData(mesh.memory.data(), mesh.memory.size());
+        return mesh;
+    }
+
+
+    MeshFile MeshFile::open(const std::string& path)
+    {
+        MeshFile mesh;
+        if (!mesh.file.open(path) || !mesh.setData(mesh.file.data(), mesh.file.size())) return {};
+        return mesh;
+    }
+
+
+    bool MeshFile::setData(const uint8_t* data, size_t size)
+    {
+        if (size < sizeof(MeshFileHeader)) return false;
+        const auto* fileHeader = reinterpret_cast<const MeshFileHeader*>(data);
+        if (fileHeader->magic != MeshFileHeader::MAGIC || fileHeader->version != MeshFileHeader::VERSION)
+            return false;
+
+        const uint64_t vertexEnd = fileHeader->vertexOffset + uint64_t{fileHeader->vertexCount} * sizeof(VertexData);
+        const uint64_t indexEnd = fileHeader->indexOffset + uint64_t{fileHeader->indexCount} * sizeof(uint32_t);
+        if (fileHeader->vertexOffset % 4 != 0 || fileHeader->indexOffset % 4 != 0 || vertexEnd > size ||
+            indexEnd > size)
+            return false;
+
+        header = fileHeader;
+        return true;
+    }
+
+
+    std::span<const VertexData> MeshFile::getVertices() const
+    {
+        const auto* data = reinterpret_cast<const uint8_t*>(header) + header->vertexOffset;
+        return {reinterpret_cast<const VertexData*>(data), header->vertexCount};
+    }
+
+
+    std::span<const uint32_t> MeshFile::getIndices() const
+    {
+        const auto* data = reinterpret_cast<const uint8_t*>(header) + header->indexOffset;
+        return {reinterpret_cast<const uint32_t*>(data), header->indexCount};
+    }
+} // grass
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace grass
+{
+    struct VertexData;
+
+
+    // Start of a .gmesh file. The vertices (VertexData) then the uint32 indices follow, at 4 bytes aligned offsets.
+    struct MeshFileHeader
+    {
+        static constexpr uint32_t MAGIC = 0x48534D47; // "GMSH"
+        static constexpr uint32_t VERSION = 2;
+
+        uint32_t magic = MAGIC;
+        uint32_t version = VERSION;
+        // Source OBJ of an imported mesh, the cached file is reused while they match
+        uint64_t sourceSize = 0;
+        int64_t sourceTime = 0;
+        uint64_t sourceHash = 0;
+        uint32_t vertexCount = 0;
+        uint32_t indexCount = 0;
+        uint64_t vertexOffset = 0;
+        uint64_t indexOffset = 0;
+        glm::vec3 boundsMin{};
+        glm::vec3 boundsMax{};
+    };
+
+
+    // Read-only mapping of a whole file
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+        ~MappedFile();
+
+        bool open(const std::string& path);
+        [[nodiscard]] const uint8_t* data() const { return bytes; }
+        [[nodiscard]] size_t size() const { return byteCount; }
+
+    private:
+        void close();
+
+        const uint8_t* bytes = nullptr;
+        size_t byteCount = 0;
+#ifdef _WIN32
+        void* fileHandle = nullptr;
+        void* mappingHandle = nullptr;
+#endif
+    };
+
+
+    // Indexed mesh read from a memory-mapped .gmesh file, its data can be uploaded straight from the mapping.
+    // No device access, meshes can be imported on a StartupScheduler thread.
+    class MeshFile
+    {
+    public:
+        // Converts the OBJ into the import cache on first load, or when the OBJ changed since.
+        // Identical vertices are merged and the triangles ordered for the vertex cache.
+        // The mesh is invalid if the OBJ can't be read.
+        static MeshFile import(const std::string& objPath);
+        // Invalid if the file is missing or was written by another version
+        static MeshFile open(const std::string& path);
+
+        [[nodiscard]] bool isValid() const { return header != nullptr; }
+        [[nodiscard]] const MeshFileHeader& getHeader() const { return *header; }
+        [[nodiscard]] std::span<const VertexData> getVertices() const;
+        [[nodiscard]] std::span<const uint32_t> getIndices() const;
+
+    private:
+        bool setData(const uint8_t* data, size_t size);
+
+        MappedFile file;
+        // Used instead of the mapping when the import cache can't be written
+        std::vector<uint8_t> memory;
+        const MeshFileHeader* header = nullptr;
+    };
+} // grass
@@ -0,0 +1,226 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+#include "Hash.h"
+#include "VertexData.h"
+
+namespace grass
+{
+    namespace
+    {
+        // Simulated cache, larger than most hardware caches as recommended by the paper
+        constexpr uint32_t CACHE_SIZE = 32;
+        constexpr float CACHE_DECAY_POWER = 1.5f;
+        constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+        constexpr float VALENCE_BOOST_SCALE = 2.0f;
+        constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+
+        struct VertexHash
+        {
+            size_t operator()(const VertexData& vertex) const { return hashBytes(&vertex, sizeof(VertexData)); }
+        };
+
+        struct VertexEqual
+        {
+            bool operator()(const VertexData& a, const VertexData& b) const
+            {
+                return std::memcmp(&a, &b, sizeof(VertexData)) == 0;
+            }
+        };
+
+
+        // Vertices of the last triangle score a bit lower, so strips don't go back and forth.
+        // Vertices with few remaining triangles are boosted to finish them off.
+        float getVertexScore(int32_t cachePosition, uint32_t remainingTriangles)
+        {
+            if (remainingTriangles == 0) return -1.0f;
+
+            float score = 0.0f;
+            if (cachePosition >= 0)
+            {
+                if (cachePosition < 3)
+                {
+                    score = LAST_TRIANGLE_SCORE;
+                }
+                else
+                {
+                    const float scale = 1.0f / (CACHE_SIZE - 3);
+                    score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scale, CACHE_DECAY_POWER);
+                }
+            }
+            return score + VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingTriangles),
+                                                          -VALENCE_BOOST_POWER);
+        }
+    }
+
+
+    void deduplicateVertices(std::span<const VertexData> corners, std::vector<VertexData>& vertices,
+                             std::vector<uint32_t>& indices)
+    {
+        vertices.clear();
+        indices.clear();
+        indices.reserve(corners.size());
+        std::unordered_map<VertexData, uint32_t, VertexHash, VertexEqual> vertexIndices;
+        vertexIndices.reserve(corners.size());
+        for (const VertexData& corner : corners)
+        {
+            const auto [it, inserted] = vertexIndices.try_emplace(corner, static_cast<uint32_t>(vertices.size()));
+            if (inserted) vertices.push_back(corner);
+            indices.push_back(it->second);
+        }
+    }
+
+
+    std::vector<uint32_t> optimizeVertexCache(std::span<const uint32_t> indices, size_t vertexCount)
+    {
+        const size_t triangleCount = indices.size() / 3;
+
+        // Triangles of each vertex, the live ones first
+        std::vector<uint32_t> liveTriangles(vertexCount, 0);
+        for (const uint32_t index : indices) liveTriangles[index]++;
+        std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+        for (size_t vertex = 0; vertex < vertexCount; vertex++)
+        {
+            adjacencyOffsets[vertex + 1] = adjacencyOffsets[vertex] + liveTriangles[vertex];
+        }
+        std::vector<uint32_t> adjacency(triangleCount * 3);
+        std::vector<uint32_t> adjacencyEnds(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; i++)
+        {
+            adjacency[adjacencyEnds[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+
+        std::vector<int32_t> cachePositions(vertexCount, -1);
+        std::vector<float> vertexScores(vertexCount);
+        for (size_t vertex = 0; vertex < vertexCount; vertex++)
+        {
+            vertexScores[vertex] = getVertexScore(-1, liveTriangles[vertex]);
+        }
+        std::vector<float> triangleScores(triangleCount);
+        for (size_t triangle = 0; triangle < triangleCount; triangle++)
+        {
+            triangleScores[triangle] = vertexScores[indices[triangle * 3]] + vertexScores[indices[triangle * 3 + 1]] +
+                vertexScores[indices[triangle * 3 + 2]];
+        }
+
+        std::vector<uint32_t> optimized;
+        optimized.reserve(triangleCount * 3);
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> cache;
+        std::vector<uint32_t> nextCache;
+        int64_t bestTriangle = -1;
+        size_t scanCursor = 0;
+        for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+        {
+            // Nothing left around the cache, start again from the first remaining triangle
+            if (bestTriangle < 0)
+            {
+                while (emitted[scanCursor]) scanCursor++;
+                bestTriangle = static_cast<int64_t>(scanCursor);
+            }
+
+            const uint32_t* triangle = &indices[bestTriangle * 3];
+            emitted[bestTriangle] = true;
+            nextCache.clear();
+            for (uint32_t corner = 0; corner < 3; corner++)
+            {
+                const uint32_t vertex = triangle[corner];
+                optimized.push_back(vertex);
+                if (std::find(nextCache.begin(), nextCache.end(), vertex) == nextCache.end())
+                {
+                    nextCache.push_back(vertex);
+                }
+
+                // Moves the triangle behind the live triangles of the vertex
+                uint32_t* liveBegin = &adjacency[adjacencyOffsets[vertex]];
+                uint32_t* liveEnd = liveBegin + liveTriangles[vertex];
+                std::iter_swap(std::find(liveBegin, liveEnd, static_cast<uint32_t>(bestTriangle)), liveEnd - 1);
+                liveTriangles[vertex]--;
+            }
+            for (const uint32_t vertex : cache)
+            {
+                if (std::find(nextCache.begin(), nextCache.end(), vertex) == nextCache.end())
+                {
+                    nextCache.push_back(vertex);
+                }
+            }
+
+            // Also rescores the vertices pushed out of the cache
+            for (size_t i = 0; i < nextCache.size(); i++)
+            {
+                const uint32_t vertex = nextCache[i];
+                cachePositions[vertex] = i < CACHE_SIZE ? static_cast<int32_t>(i) : -1;
+                const float score = getVertexScore(cachePositions[vertex], liveTriangles[vertex]);
+                const float scoreDelta = score - vertexScores[vertex];
+                vertexScores[vertex] = score;
+                for (uint32_t t = 0; t < liveTriangles[vertex]; t++)
+                {
+                    triangleScores[adjacency[adjacencyOffsets[vertex] + t]] += scoreDelta;
+                }
+            }
+            nextCache.resize(std::min<size_t>(nextCache.size(), CACHE_SIZE));
+            std::swap(cache, nextCache);
+
+            // Only triangles touching the cache can score well
+            bestTriangle = -1;
+            float bestScore = -1.0f;
+            for (const uint32_t vertex : cache)
+            {
+                for (uint32_t t = 0; t < liveTriangles[vertex]; t++)
+                {
+                    const uint32_t candidate = adjacency[adjacencyOffsets[vertex] + t];
+                    if (triangleScores[candidate] > bestScore)
+                    {
+                        bestScore = triangleScores[candidate];
+                        bestTriangle = candidate;
+                    }
+                }
+            }
+        }
+        return optimized;
+    }
+
+
+    void optimizeVertexFetch(std::vector<VertexData>& vertices, std::vector<uint32_t>& indices)
+    {
+        constexpr uint32_t UNUSED = ~0u;
+        std::vector<uint32_t> remap(vertices.size(), UNUSED);
+        std::vector<VertexData> reordered;
+        reordered.reserve(vertices.size());
+        for (uint32_t& index : indices)
+        {
+            if (remap[index] == UNUSED)
+            {
+                remap[index] = static_cast<uint32_t>(reordered.size());
+                reordered.push_back(vertices[index]);
+            }
+            index = remap[index];
+        }
+        // Unreferenced vertices are dropped
+        vertices = std::move(reordered);
+    }
+
+
+    float getAverageCacheMissRatio(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize)
+    {
+        if (indices.size() < 3) return 0.0f;
+
+        // Time each vertex entered the FIFO, it is still cached while fewer than cacheSize misses followed
+        std::vector<uint64_t> entryTimes(vertexCount, 0);
+        uint64_t misses = 0;
+        for (const uint32_t index : indices)
+        {
+            if (entryTimes[index] == 0 || misses - entryTimes[index] >= cacheSize)
+            {
+                misses++;
+                entryTimes[index] = misses;
+            }
+        }
+        return static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+    }
+} // grass
@@ -27,7 +27,7 @@ void PhongMaterial::createBindGroup()
     };
     wgpu::BindGroupDescriptor bindGroupDesc = {
         .label = "Phong material bind group",
-        .layout = GPUContext::getInstance()->getDevice().CreateBindGroupLayout(&phongMaterialBindGroupLayoutDesc),
+        .layout = GPUContext::getInstance()->getObjectCache().getBindGroupLayout(phongMaterialBindGroupLayoutDesc),
         .entryCount = 1,
         .entries = &entry[0]
     };
@@ -0,0 +1,94 @@
+#include "PipelineCache.h"
+
+#ifdef GRASS_ENABLE_PIPELINE_CACHE
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "Hash.h"
+
+
+PipelineCache::PipelineCache(std::string directory) : directory(std::move(directory))
+{
+    std::error_code error;
+    std::filesystem::create_directories(this->directory, error);
+    if (error)
+    {
+        std::cerr << "Could not create the pipeline cache directory " << this->directory << " : " << error.message()
+            << std::endl;
+        writable = false;
+    }
+}
+
+
+size_t PipelineCache::LoadData(const void* key, size_t keySize, void* value, size_t valueSize)
+{
+    std::lock_guard lock(mutex);
+    const std::vector<char>* entry = findEntry(std::string(static_cast<const char*>(key), keySize));
+    if (!entry) return 0;
+
+    // Dawn first calls with no value to get the entry size
+    if (value && valueSize >= entry->size())
+    {
+        std::memcpy(value, entry->data(), entry->size());
+    }
+    return entry->size();
+}
+
+
+void PipelineCache::StoreData(const void* key, size_t keySize, const void* value, size_t valueSize)
+{
+    std::lock_guard lock(mutex);
+    std::string keyString(static_cast<const char*>(key), keySize);
+    const auto* valueBytes = static_cast<const char*>(value);
+    std::vector<char>& entry = entries[keyString];
+    entry.assign(valueBytes, valueBytes + valueSize);
+    if (!writable) return;
+
+    // Written aside then renamed, a concurrent run never reads a partial entry
+    const std::string path = getEntryPath(keyString);
+    const std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        const uint64_t storedKeySize = keySize;
+        file.write(reinterpret_cast<const char*>(&storedKeySize), sizeof(storedKeySize));
+        file.write(keyString.data(), static_cast<std::streamsize>(keySize));
+        file.write(valueBytes, static_cast<std::streamsize>(valueSize));
+        if (!file.good()) return;
+    }
+    std::error_code error;
+    std::filesystem::rename(tmpPath, path, error);
+}
+
+
+std::string PipelineCache::getEntryPath(const std::string& key) const
+{
+    std::ostringstream name;
+    name << std::hex << hashBytes(key.data(), key.size()) << ".bin";
+    return (std::filesystem::path(directory) / name.str()).string();
+}
+
+
+const std::vector<char>* PipelineCache::findEntry(const std::string& key)
+{
+    if (const auto it = entries.find(key); it != entries.end()) return &it->second;
+
+    std::ifstream file(getEntryPath(key), std::ios::binary);
+    if (!file.is_open()) return nullptr;
+
+    // Entries start with their full key, hash collisions are misses
+    uint64_t storedKeySize = 0;
+    file.read(reinterpret_cast<char*>(&storedKeySize), sizeof(storedKeySize));
+    if (!file.good() || storedKeySize != key.size()) return nullptr;
+    std::string storedKey(key.size(), '\0');
+    file.read(storedKey.data(), static_cast<std::streamsize>(storedKey.size()));
+    if (!file.good() || storedKey != key) return nullptr;
+
+    std::vector<char> value{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    return &entries.emplace(key, std::move(value)).first->second;
+}
+
+#endif
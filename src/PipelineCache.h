@@ -0,0 +1,46 @@
+#pragma once
+
+#ifdef GRASS_ENABLE_PIPELINE_CACHE
+
+#include <dawn/platform/DawnPlatform.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Dawn blob cache persisted in a directory, one file per entry. Dawn stores compiled shaders and backend
+// pipeline caches in it, so warm starts skip Tint compilation. Keys already include the adapter and driver.
+// Dawn may call it from its worker threads.
+class PipelineCache : public dawn::platform::CachingInterface
+{
+public:
+    explicit PipelineCache(std::string directory);
+
+    size_t LoadData(const void* key, size_t keySize, void* value, size_t valueSize) override;
+    void StoreData(const void* key, size_t keySize, const void* value, size_t valueSize) override;
+
+private:
+    [[nodiscard]] std::string getEntryPath(const std::string& key) const;
+    const std::vector<char>* findEntry(const std::string& key);
+
+    std::string directory;
+    bool writable = true;
+    std::mutex mutex;
+    // Dawn asks for the size then the data of an entry, loaded entries stay in memory
+    std::unordered_map<std::string, std::vector<char>> entries;
+};
+
+
+// Hands the cache to the Dawn instance
+class PipelineCachePlatform : public dawn::platform::Platform
+{
+public:
+    explicit PipelineCachePlatform(std::string directory) : cache(std::move(directory)) {}
+
+    dawn::platform::CachingInterface* GetCachingInterface() override { return &cache; }
+
+private:
+    PipelineCache cache;
+};
+
+#endif
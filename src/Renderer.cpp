@@ -4,6 +4,7 @@
 #include <backends/imgui_impl_glfw.h>
 
 #include "layouts.h"
+#include "MeshFile.h"
 #include "Utils.h"
 
 
@@ -13,21 +14,44 @@ namespace grass
         : config(std::move(config)), size(wgpu::Extent2D{width, height})
     {
         ctx = GPUContext::getInstance();
+        useMultiSample = this->config->multiSample;
+        multiSampleCount = useMultiSample ? 4 : 1;
     }
 
 
-    bool Renderer::init(const wgpu::Buffer& computeBuffer)
+    bool Renderer::init(const BladeBuffers& bladeBuffers, StartupScheduler& scheduler)
     {
+        TRACE_ZONE("Renderer::init");
+        this->bladeBuffers = bladeBuffers;
+
+        // Assets load while the resources are created and the pipelines compile
+        auto quadMesh = scheduler.load([] { return MeshFile::import("../assets/full_screen_quad.obj"); });
+        std::array<std::future<MeshFile>, BLADE_LOD_COUNT> lodMeshes;
+        for (uint32_t lod = 0; lod < BLADE_LOD_COUNT; lod++)
+        {
+            lodMeshes[lod] = scheduler.load([lod] { return MeshFile::import(BLADE_LOD_PATHS[lod]); });
+        }
+        auto normalImage = scheduler.load([] { return loadImageData("../assets/blade_normal.png"); });
+
         if (!initGlobalResources()) return false;
         if (!initBladeResources()) return false;
         if (!initShadowResources()) return false;
         if (!createDepthTextureView()) return false;
-        if (!initSkyPipeline()) return false;
-        if (!initGrassPipeline(computeBuffer)) return false;
-        if (!initPhongPipeline()) return false;
-        if (!initShadowPipeline()) return false;
+        if (!initSkyPipeline(scheduler)) return false;
+        if (!initGrassPipeline(bladeBuffers, scheduler)) return false;
+        if (!initPhongPipeline(scheduler)) return false;
+        if (!initShadowPipeline(scheduler)) return false;
 
-        return true;
+        fullScreenQuad = MeshGeomoetry("../assets/full_screen_quad.obj", quadMesh.get());
+        for (uint32_t lod = 0; lod < BLADE_LOD_COUNT; lod++)
+        {
+            bladeLodGeometries[lod] = MeshGeomoetry(BLADE_LOD_PATHS[lod], lodMeshes[lod].get());
+            // The culling pass only fills instance counts
+            const uint32_t bladeIndexCount = bladeLodGeometries[lod].getIndexCount();
+            ctx->getQueue().WriteBuffer(bladeBuffers.drawArgs, lod * sizeof(DrawIndexedIndirectArgs),
+                                        &bladeIndexCount, sizeof(uint32_t));
+        }
+        return createGrassBindGroup(bladeBuffers, normalImage.get());
     }
 
 
@@ -45,10 +69,10 @@ namespace grass
             .magFilter = wgpu::FilterMode::Linear,
             .minFilter = wgpu::FilterMode::Linear,
         };
-        globalTextureSampler = ctx->getDevice().CreateSampler(&samplerDesc);
+        globalTextureSampler = ctx->getObjectCache().getSampler(samplerDesc);
 
-        wgpu::BindGroupLayout globalBindGroupLayout = ctx->getDevice().
-                                                           CreateBindGroupLayout(&globalBindGroupLayoutDesc);
+        wgpu::BindGroupLayout globalBindGroupLayout = ctx->getObjectCache().getBindGroupLayout(
+            globalBindGroupLayoutDesc);
         wgpu::BindGroupEntry globalEntry[globalBindGroupLayoutDesc.entryCount] = {
             {
                 .binding = 0,
@@ -75,8 +99,6 @@ namespace grass
 
     bool Renderer::initBladeResources()
     {
-        bladeNormalTexture = loadTexture("../assets/blade_normal.png");
-
         wgpu::BufferDescriptor bladeUniformBufferDesc = {
             .label = "Blade uniform buffer",
             .usage = wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::Uniform,
@@ -115,20 +137,21 @@ namespace grass
     }
 
 
-    bool Renderer::initSkyPipeline()
+    bool Renderer::initSkyPipeline(StartupScheduler& scheduler)
     {
-        wgpu::ShaderModule skyVert = getShaderModule(ctx->getDevice(), "../shaders/full_screen_quad.vert.wgsl",
-                                                     "Sky Vertex shader");
-        wgpu::ShaderModule skyFrag = getShaderModule(ctx->getDevice(), "../shaders/sky.frag.wgsl",
-                                                     "Sky Frag shader");
+        ShaderManager& shaderManager = ctx->getShaderManager();
+        wgpu::ShaderModule skyVert = shaderManager.getModule("../shaders/full_screen_quad.vert.wgsl",
+                                                             "Sky Vertex shader");
+        wgpu::ShaderModule skyFrag = shaderManager.getModule("../shaders/sky.frag.wgsl", "Sky Frag shader");
 
-        wgpu::BindGroupLayout bindGroupLayouts = ctx->getDevice().CreateBindGroupLayout(&globalBindGroupLayoutDesc);
+        wgpu::BindGroupLayout bindGroupLayouts = ctx->getObjectCache().getBindGroupLayout(
+            globalBindGroupLayoutDesc);
         wgpu::PipelineLayoutDescriptor skyPipelineLayoutDesc = {
             .label = "Sky pipeline layout",
             .bindGroupLayoutCount = 1,
             .bindGroupLayouts = &bindGroupLayouts
         };
-        wgpu::PipelineLayout pipelineLayout = ctx->getDevice().CreatePipelineLayout(&skyPipelineLayoutDesc);
+        wgpu::PipelineLayout pipelineLayout = ctx->getObjectCache().getPipelineLayout(skyPipelineLayoutDesc);
 
         wgpu::RenderPipelineDescriptor skyPipelineDesc;
         skyPipelineDesc.label = "Sky pipeline";
@@ -136,7 +159,7 @@ namespace grass
         skyPipelineDesc.vertex.module = skyVert;
         skyPipelineDesc.vertex.bufferCount = 1;
         skyPipelineDesc.vertex.buffers = &defaultVertexLayout;
-        skyPipelineDesc.multisample.count = MULTI_SAMPLE_COUNT;
+        skyPipelineDesc.multisample.count = multiSampleCount;
 
         wgpu::ColorTargetState colorTarget;
         colorTarget.format = ctx->getSurfaceFormat();
@@ -148,20 +171,23 @@ namespace grass
         };
         skyPipelineDesc.fragment = &fragmentState;
 
-        skyPipeline = ctx->getDevice().CreateRenderPipeline(&skyPipelineDesc);
+        scheduler.createPipeline(skyPipelineDesc, skyPipeline);
 
-        return skyPipeline != nullptr;
+        return true;
     }
 
 
-    bool Renderer::initGrassPipeline(const wgpu::Buffer& computeBuffer)
+    bool Renderer::initGrassPipeline(const BladeBuffers& bladeBuffers, StartupScheduler& scheduler)
     {
-        wgpu::ShaderModule grassVert = getShaderModule(ctx->getDevice(), "../shaders/blade.vert.wgsl",
-                                                       "Grass vertex shader");
-        wgpu::ShaderModule fragVert = getShaderModule(ctx->getDevice(), "../shaders/blade.frag.wgsl",
-                                                      "Grass vertex shader");
+        grassDrawArgsBuffer = bladeBuffers.drawArgs;
+        visibleBladesLodStride = bladeBuffers.lodStride;
 
-        wgpu::BindGroupLayoutEntry grassLayoutEntry[4] = {
+        ShaderManager& shaderManager = ctx->getShaderManager();
+        wgpu::ShaderModule grassVert = shaderManager.getModule("../shaders/blade.vert.wgsl", "Grass vertex shader",
+                                                               {getBladeLayoutPath(config->packedBlades)});
+        wgpu::ShaderModule fragVert = shaderManager.getModule("../shaders/blade.frag.wgsl", "Grass vertex shader");
+
+        wgpu::BindGroupLayoutEntry grassLayoutEntry[6] = {
             {
                 .binding = 0,
                 .visibility = wgpu::ShaderStage::Vertex | wgpu::ShaderStage::Fragment,
@@ -175,7 +201,7 @@ namespace grass
                 .visibility = wgpu::ShaderStage::Vertex,
                 .buffer = {
                     .type = wgpu::BufferBindingType::ReadOnlyStorage,
-                    .minBindingSize = computeBuffer.GetSize()
+                    .minBindingSize = bladeBuffers.staticBlades.GetSize()
                 }
             },
             {
@@ -193,19 +219,35 @@ namespace grass
                     .sampleType = wgpu::TextureSampleType::Float,
                     .viewDimension = wgpu::TextureViewDimension::e2D
                 }
+            },
+            {
+                .binding = 4,
+                .visibility = wgpu::ShaderStage::Vertex,
+                .buffer = {
+                    .type = wgpu::BufferBindingType::ReadOnlyStorage,
+                    .hasDynamicOffset = true,
+                    .minBindingSize = bladeBuffers.lodStride
+                }
+            },
+            {
+                .binding = 5,
+                .visibility = wgpu::ShaderStage::Vertex,
+                .buffer = {
+                    .type = wgpu::BufferBindingType::ReadOnlyStorage,
+                    .minBindingSize = bladeBuffers.dynamicBlades.GetSize()
+                }
             }
         };
 
         wgpu::BindGroupLayoutDescriptor bladeUniformBindGroupLayoutDesc = {
             .label = "Blade shading uniform bind group layout",
-            .entryCount = 4,
+            .entryCount = 6,
             .entries = &grassLayoutEntry[0]
         };
 
-        wgpu::BindGroupLayout globalBindGroupLayout = ctx->getDevice().
-                                                           CreateBindGroupLayout(&globalBindGroupLayoutDesc);
-        wgpu::BindGroupLayout bladeUniformBindGroupLayout = ctx->getDevice().CreateBindGroupLayout(
-            &bladeUniformBindGroupLayoutDesc);
+        wgpu::BindGroupLayout globalBindGroupLayout = ctx->getObjectCache().getBindGroupLayout(
+            globalBindGroupLayoutDesc);
+        bladeUniformBindGroupLayout = ctx->getObjectCache().getBindGroupLayout(bladeUniformBindGroupLayoutDesc);
 
         wgpu::BindGroupLayout bindGroupLayouts[2] = {
             globalBindGroupLayout, bladeUniformBindGroupLayout
@@ -215,7 +257,7 @@ namespace grass
             .bindGroupLayoutCount = 2,
             .bindGroupLayouts = &bindGroupLayouts[0]
         };
-        wgpu::PipelineLayout pipelineLayout = ctx->getDevice().CreatePipelineLayout(&pipelineLayoutdesc);
+        wgpu::PipelineLayout pipelineLayout = ctx->getObjectCache().getPipelineLayout(pipelineLayoutdesc);
 
         wgpu::RenderPipelineDescriptor grassPipelineDesc;
         grassPipelineDesc.label = "Grass pipeline";
@@ -234,10 +276,19 @@ namespace grass
         };
         grassPipelineDesc.fragment = &fragmentState;
 
-        grassPipelineDesc.multisample.count = MULTI_SAMPLE_COUNT;
+        grassPipelineDesc.multisample.count = multiSampleCount;
         grassPipelineDesc.depthStencil = &defaultDepthStencil;
 
-        grassPipeline = ctx->getDevice().CreateRenderPipeline(&grassPipelineDesc);
+        scheduler.createPipeline(grassPipelineDesc, grassPipeline);
+
+        return bladeUniformBindGroupLayout != nullptr;
+    }
+
+
+    bool Renderer::createGrassBindGroup(const BladeBuffers& bladeBuffers, const ImageData& normalImage)
+    {
+        bladeNormalTexture = createTexture(normalImage);
+        if (bladeNormalTexture == nullptr) return false;
 
         wgpu::TextureViewDescriptor normalTextureViewDesc = {
             .format = bladeNormalTexture.GetFormat(),
@@ -247,7 +298,7 @@ namespace grass
         };
         wgpu::TextureView normalTextureView = bladeNormalTexture.CreateView(&normalTextureViewDesc);
 
-        wgpu::BindGroupEntry bladeUniformEntry[4] = {
+        wgpu::BindGroupEntry bladeUniformEntry[6] = {
             {
                 .binding = 0,
                 .buffer = bladeUniformBuffer,
@@ -256,9 +307,9 @@ namespace grass
             },
             {
                 .binding = 1,
-                .buffer = computeBuffer,
+                .buffer = bladeBuffers.staticBlades,
                 .offset = 0,
-                .size = computeBuffer.GetSize()
+                .size = bladeBuffers.staticBlades.GetSize()
             },
             {
                 .binding = 2,
@@ -268,40 +319,50 @@ namespace grass
                 .binding = 3,
                 .textureView = shadowTexture.CreateView(),
             },
-
+            {
+                .binding = 4,
+                .buffer = bladeBuffers.visibleBlades,
+                .offset = 0,
+                .size = bladeBuffers.lodStride
+            },
+            {
+                .binding = 5,
+                .buffer = bladeBuffers.dynamicBlades,
+                .offset = 0,
+                .size = bladeBuffers.dynamicBlades.GetSize()
+            },
         };
         wgpu::BindGroupDescriptor storageBindGroupDesc = {
             .label = "Blade uniform bind group",
             .layout = bladeUniformBindGroupLayout,
-            .entryCount = bladeUniformBindGroupLayoutDesc.entryCount,
+            .entryCount = 6,
             .entries = &bladeUniformEntry[0]
         };
         bladeUniformBindGroup = ctx->getDevice().CreateBindGroup(&storageBindGroupDesc);
 
-        return grassPipeline != nullptr && bladeUniformBindGroup != nullptr;
+        return bladeUniformBindGroup != nullptr;
     }
 
 
-    bool Renderer::initPhongPipeline()
+    bool Renderer::initPhongPipeline(StartupScheduler& scheduler)
     {
-        wgpu::ShaderModule phongVert = getShaderModule(ctx->getDevice(), "../shaders/phong.vert.wgsl",
-                                                       "Phong vertex shader");
-        wgpu::ShaderModule phongFrag = getShaderModule(ctx->getDevice(), "../shaders/phong.frag.wgsl",
-                                                       "Phong frag shader");
+        ShaderManager& shaderManager = ctx->getShaderManager();
+        wgpu::ShaderModule phongVert = shaderManager.getModule("../shaders/phong.vert.wgsl", "Phong vertex shader");
+        wgpu::ShaderModule phongFrag = shaderManager.getModule("../shaders/phong.frag.wgsl", "Phong frag shader");
 
         wgpu::RenderPipelineDescriptor phongPipelineDesc;
 
         wgpu::BindGroupLayout bindGroupLayouts[3] = {
-            ctx->getDevice().CreateBindGroupLayout(&globalBindGroupLayoutDesc),
-            ctx->getDevice().CreateBindGroupLayout(&phongMaterialBindGroupLayoutDesc),
-            ctx->getDevice().CreateBindGroupLayout(&modelBindGroupLayoutDesc)
+            ctx->getObjectCache().getBindGroupLayout(globalBindGroupLayoutDesc),
+            ctx->getObjectCache().getBindGroupLayout(phongMaterialBindGroupLayoutDesc),
+            ctx->getObjectCache().getBindGroupLayout(modelBindGroupLayoutDesc)
         };
         wgpu::PipelineLayoutDescriptor pipelineLayoutDesc = {
             .label = "Phong pipeline layout",
             .bindGroupLayoutCount = 3,
             .bindGroupLayouts = &bindGroupLayouts[0]
         };
-        wgpu::PipelineLayout pipelineLayout = ctx->getDevice().CreatePipelineLayout(&pipelineLayoutDesc);
+        wgpu::PipelineLayout pipelineLayout = ctx->getObjectCache().getPipelineLayout(pipelineLayoutDesc);
         phongPipelineDesc.label = "Phong pipeline";
         phongPipelineDesc.layout = pipelineLayout;
         phongPipelineDesc.vertex.module = phongVert;
@@ -318,21 +379,46 @@ namespace grass
         };
         phongPipelineDesc.fragment = &fragmentState;
         phongPipelineDesc.depthStencil = &defaultDepthStencil;
-        phongPipelineDesc.multisample.count = MULTI_SAMPLE_COUNT;
+        phongPipelineDesc.multisample.count = multiSampleCount;
 
-        phongPipeline = ctx->getDevice().CreateRenderPipeline(&phongPipelineDesc);
+        scheduler.createPipeline(phongPipelineDesc, phongPipeline);
 
-        return phongPipeline != nullptr;
+        // Room for 1024 meshes, the ring grows past that
+        if (!modelMatrices.init("Model matrix ring buffer", 1024 * sizeof(glm::mat4), wgpu::BufferUsage::Storage))
+        {
+            return false;
+        }
+        return createModelBindGroup();
     }
 
 
-    bool Renderer::initShadowPipeline()
+    bool Renderer::createModelBindGroup()
     {
-        wgpu::ShaderModule shadowVert = getShaderModule(ctx->getDevice(), "../shaders/full_screen_quad.vert.wgsl",
-                                                        "ScreenSpaceShadow vertex shader");
-        wgpu::ShaderModule shadowFrag = getShaderModule(ctx->getDevice(),
-                                                        "../shaders/screen_space_shadows.frag.wgsl",
-                                                        "ScreenSpaceShadow frag shader");
+        wgpu::BindGroupEntry entry = {
+            .binding = 0,
+            .buffer = modelMatrices.getBuffer(),
+            .offset = 0,
+            .size = modelMatrices.getFrameCapacity()
+        };
+        wgpu::BindGroupDescriptor bindGroupDesc = {
+            .label = "Model bind group",
+            .layout = ctx->getObjectCache().getBindGroupLayout(modelBindGroupLayoutDesc),
+            .entryCount = 1,
+            .entries = &entry
+        };
+        modelBindGroup = ctx->getDevice().CreateBindGroup(&bindGroupDesc);
+        return modelBindGroup != nullptr;
+    }
+
+
+    bool Renderer::initShadowPipeline(StartupScheduler& scheduler)
+    {
+        ShaderManager& shaderManager = ctx->getShaderManager();
+        wgpu::ShaderModule shadowVert = shaderManager.getModule("../shaders/full_screen_quad.vert.wgsl",
+                                                                "ScreenSpaceShadow vertex shader");
+        wgpu::ShaderModule shadowFrag = shaderManager.getModule("../shaders/screen_space_shadows.frag.wgsl",
+                                                                "ScreenSpaceShadow frag shader",
+                                                                {getShadowDepthPath(useMultiSample)});
 
         wgpu::BindGroupLayoutEntry shadowLayoutEntry[3] = {
             {
@@ -341,7 +427,7 @@ namespace grass
                 .texture = {
                     .sampleType = wgpu::TextureSampleType::Depth,
                     .viewDimension = wgpu::TextureViewDimension::e2D,
-                    .multisampled = USE_MULTI_SAMPLE
+                    .multisampled = useMultiSample
                 }
             },
             {
@@ -368,11 +454,11 @@ namespace grass
             .entryCount = 3,
             .entries = &shadowLayoutEntry[0]
         };
-        wgpu::BindGroupLayout shadowBindGroupLayout = ctx->getDevice().
-                                                           CreateBindGroupLayout(&shadowBindGroupLayoutDesc);
+        wgpu::BindGroupLayout shadowBindGroupLayout = ctx->getObjectCache().getBindGroupLayout(
+            shadowBindGroupLayoutDesc);
 
         wgpu::BindGroupLayout bindGroupLayouts[2] = {
-            ctx->getDevice().CreateBindGroupLayout(&globalBindGroupLayoutDesc),
+            ctx->getObjectCache().getBindGroupLayout(globalBindGroupLayoutDesc),
             shadowBindGroupLayout
         };
         wgpu::PipelineLayoutDescriptor pipelineLayoutDesc = {
@@ -380,7 +466,7 @@ namespace grass
             .bindGroupLayoutCount = 2,
             .bindGroupLayouts = &bindGroupLayouts[0]
         };
-        wgpu::PipelineLayout pipelineLayout = ctx->getDevice().CreatePipelineLayout(&pipelineLayoutDesc);
+        wgpu::PipelineLayout pipelineLayout = ctx->getObjectCache().getPipelineLayout(pipelineLayoutDesc);
 
         wgpu::RenderPipelineDescriptor shadowPipelineDesc;
         shadowPipelineDesc.label = "Shadow pipeline";
@@ -406,9 +492,9 @@ namespace grass
             .targets = &colorTarget
         };
         shadowPipelineDesc.fragment = &fragmentState;
-        shadowPipelineDesc.multisample.count = MULTI_SAMPLE_COUNT;
+        shadowPipelineDesc.multisample.count = multiSampleCount;
 
-        shadowPipeline = ctx->getDevice().CreateRenderPipeline(&shadowPipelineDesc);
+        scheduler.createPipeline(shadowPipelineDesc, shadowPipeline);
 
         wgpu::BindGroupEntry shadowUniformEntry[3] = {
             {
@@ -432,7 +518,7 @@ namespace grass
         };
         shadowUniformBindGroup = ctx->getDevice().CreateBindGroup(&bindGroupDesc);
 
-        return shadowPipeline != nullptr && shadowUniformBindGroup != nullptr;
+        return shadowUniformBindGroup != nullptr;
     }
 
 
@@ -445,7 +531,7 @@ namespace grass
             .size = {size.width, size.height, 1},
             .format = wgpu::TextureFormat::Depth24Plus,
             .mipLevelCount = 1,
-            .sampleCount = MULTI_SAMPLE_COUNT,
+            .sampleCount = multiSampleCount,
         };
         wgpu::Texture depthTexture = ctx->getDevice().CreateTexture(&depthTextureDesc);
 
@@ -507,14 +593,16 @@ namespace grass
     void Renderer::drawSky(const wgpu::CommandEncoder& encoder, const wgpu::TextureView& targetView)
     {
         wgpu::RenderPassColorAttachment fullScreenPassColorAttachment = {
-            .view = USE_MULTI_SAMPLE ? multisampleView : targetView,
+            .view = useMultiSample ? multisampleView : targetView,
             .resolveTarget = nullptr,
             .loadOp = wgpu::LoadOp::Clear,
             .storeOp = wgpu::StoreOp::Store,
         };
         wgpu::RenderPassDescriptor fullScreenPassDesc = {
+            .label = "Sky render pass",
             .colorAttachmentCount = 1,
             .colorAttachments = &fullScreenPassColorAttachment,
+            .timestampWrites = ctx->getProfiler().renderPass("Sky"),
         };
 
         wgpu::RenderPassEncoder fullScreenPass = encoder.BeginRenderPass(&fullScreenPassDesc);
@@ -528,7 +616,7 @@ namespace grass
     void Renderer::drawGrass(const wgpu::CommandEncoder& encoder, const wgpu::TextureView& targetView)
     {
         wgpu::RenderPassColorAttachment renderPassColorAttachment = {
-            .view = USE_MULTI_SAMPLE ? multisampleView : targetView,
+            .view = useMultiSample ? multisampleView : targetView,
             .resolveTarget = nullptr,
             .loadOp = wgpu::LoadOp::Load,
             .storeOp = wgpu::StoreOp::Store,
@@ -544,9 +632,26 @@ namespace grass
             .colorAttachmentCount = 1,
             .colorAttachments = &renderPassColorAttachment,
             .depthStencilAttachment = &renderPassDepthAttachment,
+            .timestampWrites = ctx->getProfiler().renderPass("Grass"),
         };
+
+        wgpu::RenderPassEncoder renderPass = encoder.BeginRenderPass(&renderPassDesc);
+        renderPass.SetPipeline(grassPipeline);
+        renderPass.SetBindGroup(0, globalBindGroup, 0, nullptr);
+        for (uint32_t lod = 0; lod < BLADE_LOD_COUNT; lod++)
+        {
+            const auto visibleBladesOffset = static_cast<uint32_t>(lod * visibleBladesLodStride);
+            renderPass.SetBindGroup(1, bladeUniformBindGroup, 1, &visibleBladesOffset);
+            bladeLodGeometries[lod].drawIndirect(renderPass, grassDrawArgsBuffer, lod * sizeof(DrawIndexedIndirectArgs));
+        }
+        renderPass.End();
+    }
+
+
+    void Renderer::drawShadows(const wgpu::CommandEncoder& encoder, const wgpu::TextureView& targetView)
+    {
         wgpu::RenderPassColorAttachment fullSreenColorAttachment = {
-            .view = USE_MULTI_SAMPLE ? multisampleView : targetView,
+            .view = useMultiSample ? multisampleView : targetView,
             .loadOp = wgpu::LoadOp::Load,
             .storeOp = wgpu::StoreOp::Store,
         };
@@ -554,15 +659,9 @@ namespace grass
             .label = "Shadow render Pass",
             .colorAttachmentCount = 1,
             .colorAttachments = &fullSreenColorAttachment,
+            .timestampWrites = ctx->getProfiler().renderPass("Screen-space shadows"),
         };
 
-        wgpu::RenderPassEncoder renderPass = encoder.BeginRenderPass(&renderPassDesc);
-        renderPass.SetPipeline(grassPipeline);
-        renderPass.SetBindGroup(0, globalBindGroup, 0, nullptr);
-        renderPass.SetBindGroup(1, bladeUniformBindGroup, 0, nullptr);
-        bladeGeometry.draw(renderPass, config->totalBlades);
-        renderPass.End();
-
         wgpu::RenderPassEncoder fullScreenPass = encoder.BeginRenderPass(&fullSreenPassDesc);
         fullScreenPass.SetPipeline(shadowPipeline);
         fullScreenPass.SetBindGroup(0, globalBindGroup, 0, nullptr);
@@ -573,11 +672,11 @@ namespace grass
 
 
     void Renderer::drawScene(const wgpu::CommandEncoder& encoder, const wgpu::TextureView& targetView,
-                             const std::vector<Mesh>& scene)
+                             uint32_t modelOffset)
     {
         wgpu::RenderPassColorAttachment renderPassColorAttachment = {
-            .view = USE_MULTI_SAMPLE ? multisampleView : targetView,
-            .resolveTarget = USE_MULTI_SAMPLE ? targetView : nullptr,
+            .view = useMultiSample ? multisampleView : targetView,
+            .resolveTarget = useMultiSample ? targetView : nullptr,
             .loadOp = wgpu::LoadOp::Load,
             .storeOp = wgpu::StoreOp::Store,
         };
@@ -591,16 +690,17 @@ namespace grass
             .colorAttachmentCount = 1,
             .colorAttachments = &renderPassColorAttachment,
             .depthStencilAttachment = &renderPassDepthAttachment,
+            .timestampWrites = ctx->getProfiler().renderPass("Scene"),
         };
 
         wgpu::RenderPassEncoder pass = encoder.BeginRenderPass(&renderPassDesc);
         pass.SetPipeline(phongPipeline);
         pass.SetBindGroup(0, globalBindGroup, 0, nullptr);
-        for (auto mesh : scene)
+        pass.SetBindGroup(2, modelBindGroup, 1, &modelOffset);
+        for (const SceneBatch& batch : sceneBatcher.getBatches())
         {
-            pass.SetBindGroup(1, mesh.material.bindGroup, 0, nullptr);
-            pass.SetBindGroup(2, mesh.bindGroup, 0, nullptr);
-            mesh.draw(pass, 1);
+            pass.SetBindGroup(1, batch.material->bindGroup, 0, nullptr);
+            batch.geometry->draw(pass, batch.instanceCount, batch.firstInstance);
         }
         pass.End();
     }
@@ -617,6 +717,7 @@ namespace grass
             .label = "ImGui Render Pass",
             .colorAttachmentCount = 1,
             .colorAttachments = &imGuiColorAttachment,
+            .timestampWrites = ctx->getProfiler().renderPass("ImGui"),
         };
         wgpu::RenderPassEncoder pass = encoder.BeginRenderPass(&imGuiRenderPassDesc);
 
@@ -626,39 +727,63 @@ namespace grass
     }
 
 
-    void Renderer::render(const std::vector<Mesh>& scene, const Camera& camera, float time, uint32_t frameNumber)
+    bool Renderer::render(FrameGraph& frameGraph, const std::vector<Mesh>& scene, const Camera& camera, float time,
+                          uint32_t frameNumber)
     {
-        if (!multisampleView)
+        TRACE_ZONE("Renderer::render");
+        if (useMultiSample && !multisampleView)
         {
             wgpu::TextureDescriptor msTextureDesc = {
                 .usage = wgpu::TextureUsage::RenderAttachment,
                 .size = {size.width, size.height, 1},
                 .format = ctx->getSurfaceFormat(),
-                .sampleCount = MULTI_SAMPLE_COUNT
+                .sampleCount = multiSampleCount
             };
             wgpu::Texture multisampleTexture = ctx->getDevice().CreateTexture(&msTextureDesc);
             multisampleView = multisampleTexture.CreateView();
         }
 
         wgpu::TextureView targetView = ctx->getNextSurfaceTextureView();
-        if (!targetView) return;
-
-        wgpu::CommandEncoderDescriptor encoderDesc;
-        wgpu::CommandEncoder encoder = ctx->getDevice().CreateCommandEncoder(&encoderDesc);
+        if (!targetView) return false;
 
+        // Uploads go before the frame's single submit, never in the middle of pass recording
         updateGlobalUniforms(camera, time, frameNumber);
-        drawSky(encoder, targetView);
-        drawGrass(encoder, targetView);
-        drawScene(encoder, targetView, scene);
-
-        if (showGui)
-            drawGUI(encoder, targetView);
-
-        wgpu::CommandBufferDescriptor cmdBufferDescriptor = {
-            .label = "Rendering operations command buffer"
-        };
-        wgpu::CommandBuffer command = encoder.Finish(&cmdBufferDescriptor);
-        ctx->getQueue().Submit(1, &command);
-        ctx->getSurface().Present();
+        sceneBatcher.build(scene);
+        const std::vector<glm::mat4>& models = sceneBatcher.getModels();
+        modelMatrices.beginFrame();
+        if (!models.empty()) modelMatrices.allocate(models.data(), models.size() * sizeof(glm::mat4));
+        if (modelMatrices.upload() && !createModelBindGroup()) return false;
+        const uint32_t modelOffset = modelMatrices.getFrameOffset();
+
+        const wgpu::TextureView colorView = useMultiSample ? multisampleView : targetView;
+        frameGraph.addPass("Sky", FramePassType::Render, {}, {colorView},
+                           [this, targetView](const wgpu::CommandEncoder& encoder) { drawSky(encoder, targetView); });
+        frameGraph.addPass("Grass", FramePassType::Render,
+                           {
+                               bladeBuffers.staticBlades, bladeBuffers.dynamicBlades, bladeBuffers.visibleBlades,
+                               bladeBuffers.drawArgs, shadowTexture
+                           },
+                           {colorView, depthView},
+                           [this, targetView](const wgpu::CommandEncoder& encoder) { drawGrass(encoder, targetView); });
+        frameGraph.addPass("Screen-space shadows", FramePassType::Render, {depthView}, {colorView, shadowTexture},
+                           [this, targetView](const wgpu::CommandEncoder& encoder)
+                           {
+                               drawShadows(encoder, targetView);
+                           });
+        frameGraph.addPass("Scene", FramePassType::Render, {}, {colorView, targetView, depthView},
+                           [this, targetView, modelOffset](const wgpu::CommandEncoder& encoder)
+                           {
+                               drawScene(encoder, targetView, modelOffset);
+                           });
+
+        if (showGui && !config->headless)
+        {
+            frameGraph.addPass("ImGui", FramePassType::Render, {}, {targetView},
+                               [this, targetView](const wgpu::CommandEncoder& encoder)
+                               {
+                                   drawGUI(encoder, targetView);
+                               });
+        }
+        return true;
     }
 } // grass
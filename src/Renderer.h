@@ -1,26 +1,36 @@
 #pragma once
 
 #include <webgpu/webgpu_cpp.h>
+#include <array>
 #include <string>
 #include <memory>
 
 #include "Camera.h"
+#include "ComputeManager.h"
+#include "FrameGraph.h"
+#include "FrameBufferAllocator.h"
 #include "GPUContext.h"
 #include "GlobalConfig.h"
 #include "Mesh.h"
+#include "SceneBatcher.h"
+#include "StartupScheduler.h"
 
 namespace grass
 {
+    struct ImageData;
+
+
     class Renderer
     {
-        const bool USE_MULTI_SAMPLE = true;
-        const uint32_t MULTI_SAMPLE_COUNT = USE_MULTI_SAMPLE ? 4 : 1;
-
     public:
         Renderer(std::shared_ptr<GlobalConfig> config, uint16_t width, uint16_t height);
         ~Renderer() = default;
-        bool init(const wgpu::Buffer& computeBuffer);
-        void render(const std::vector<Mesh>& scene, const Camera& camera, float time, uint32_t frameNumber);
+        // Pipelines are created by the scheduler, they are ready once it has waited
+        bool init(const BladeBuffers& bladeBuffers, StartupScheduler& scheduler);
+        // Adds the frame's passes, false when there is no target to render into. The scene must outlive the graph
+        // execution.
+        bool render(FrameGraph& frameGraph, const std::vector<Mesh>& scene, const Camera& camera, float time,
+                    uint32_t frameNumber);
         void toggleGUI();
         void updateBladeUniforms();
         void updateShadowUniforms();
@@ -30,18 +40,24 @@ namespace grass
         bool initBladeResources();
         bool initShadowResources();
         bool createDepthTextureView();
-        bool initSkyPipeline();
-        bool initGrassPipeline(const wgpu::Buffer& computeBuffer);
-        bool initPhongPipeline();
-        bool initShadowPipeline();
+        bool initSkyPipeline(StartupScheduler& scheduler);
+        bool initGrassPipeline(const BladeBuffers& bladeBuffers, StartupScheduler& scheduler);
+        bool createGrassBindGroup(const BladeBuffers& bladeBuffers, const ImageData& normalImage);
+        bool initPhongPipeline(StartupScheduler& scheduler);
+        bool createModelBindGroup();
+        bool initShadowPipeline(StartupScheduler& scheduler);
         void updateGlobalUniforms(const Camera& camera, float time, uint32_t frameNumber);
         void drawSky(const wgpu::CommandEncoder& encoder, const wgpu::TextureView& targetView);
         void drawGrass(const wgpu::CommandEncoder& encoder, const wgpu::TextureView& targetView);
+        void drawShadows(const wgpu::CommandEncoder& encoder, const wgpu::TextureView& targetView);
+        // One instanced draw per scene batch, modelOffset is the dynamic offset of the frame's model matrices
         void drawScene(const wgpu::CommandEncoder& encoder, const wgpu::TextureView& targetView,
-                       const std::vector<Mesh>& scene);
+                       uint32_t modelOffset);
         void drawGUI(const wgpu::CommandEncoder& encoder, const wgpu::TextureView& targetView);
 
         std::shared_ptr<GlobalConfig> config;
+        bool useMultiSample = true;
+        uint32_t multiSampleCount = 4;
         bool showGui = true;
         GPUContext* ctx = nullptr;
         wgpu::Extent2D size;
@@ -53,15 +69,29 @@ namespace grass
         wgpu::Sampler globalTextureSampler;
 
         wgpu::RenderPipeline phongPipeline;
+        SceneBatcher sceneBatcher;
+        // Model matrices of the scene batches, rewritten every frame
+        FrameBufferAllocator modelMatrices;
+        wgpu::BindGroup modelBindGroup;
 
         wgpu::RenderPipeline skyPipeline;
-        MeshGeomoetry fullScreenQuad{"../assets/full_screen_quad.obj"};
+        MeshGeomoetry fullScreenQuad;
 
+        BladeBuffers bladeBuffers;
         wgpu::RenderPipeline grassPipeline;
+        wgpu::Buffer grassDrawArgsBuffer;
+        uint64_t visibleBladesLodStride = 0;
         wgpu::Buffer bladeUniformBuffer;
+        wgpu::BindGroupLayout bladeUniformBindGroupLayout;
         wgpu::BindGroup bladeUniformBindGroup;
         wgpu::Texture bladeNormalTexture;
-        MeshGeomoetry bladeGeometry{"../assets/grass_blade.obj"};
+        // 7, 3 and 1 segments
+        static constexpr std::array<const char*, BLADE_LOD_COUNT> BLADE_LOD_PATHS = {
+            "../assets/grass_blade.obj",
+            "../assets/grass_blade_lod1.obj",
+            "../assets/grass_blade_lod2.obj",
+        };
+        std::array<MeshGeomoetry, BLADE_LOD_COUNT> bladeLodGeometries;
 
         // TODO ScreenSpaceShadow could be done by compute shader
         wgpu::RenderPipeline shadowPipeline;
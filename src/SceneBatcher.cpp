@@ -0,0 +1,41 @@
+#include "SceneBatcher.h"
+
+#include <map>
+#include <utility>
+
+#include "Tracer.h"
+
+namespace grass
+{
+    void SceneBatcher::build(const std::vector<Mesh>& scene)
+    {
+        TRACE_ZONE("SceneBatcher::build");
+        batches.clear();
+        meshBatches.resize(scene.size());
+        std::map<std::pair<const void*, const void*>, uint32_t> batchIndices;
+        for (size_t i = 0; i < scene.size(); i++)
+        {
+            const Mesh& mesh = scene[i];
+            const std::pair<const void*, const void*> key = {mesh.geometry.getKey(), mesh.material.bindGroup.Get()};
+            const auto [it, inserted] = batchIndices.try_emplace(key, static_cast<uint32_t>(batches.size()));
+            if (inserted) batches.push_back({.geometry = &mesh.geometry, .material = &mesh.material});
+            batches[it->second].instanceCount++;
+            meshBatches[i] = it->second;
+        }
+
+        uint32_t firstInstance = 0;
+        for (SceneBatch& batch : batches)
+        {
+            batch.firstInstance = firstInstance;
+            firstInstance += batch.instanceCount;
+            batch.instanceCount = 0;
+        }
+
+        models.resize(scene.size());
+        for (size_t i = 0; i < scene.size(); i++)
+        {
+            SceneBatch& batch = batches[meshBatches[i]];
+            models[batch.firstInstance + batch.instanceCount++] = scene[i].model;
+        }
+    }
+} // grass
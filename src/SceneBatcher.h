@@ -0,0 +1,40 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "Mesh.h"
+
+namespace grass
+{
+    // Meshes sharing a geometry and a material, drawn with one instanced call
+    struct SceneBatch
+    {
+        const MeshGeomoetry* geometry = nullptr;
+        const PhongMaterial* material = nullptr;
+        // Range of the batch in the packed model matrices
+        uint32_t firstInstance = 0;
+        uint32_t instanceCount = 0;
+    };
+
+
+    // Groups the scene meshes by geometry and material, the draw count then follows the unique assets.
+    // Copies of a Mesh share their GPU objects and land in the same batch.
+    class SceneBatcher
+    {
+    public:
+        // Batches keep pointers into the scene, which must outlive them
+        void build(const std::vector<Mesh>& scene);
+
+        [[nodiscard]] const std::vector<SceneBatch>& getBatches() const { return batches; }
+        // Model matrices of the batches one after the other, indexed by instance
+        [[nodiscard]] const std::vector<glm::mat4>& getModels() const { return models; }
+
+    private:
+        std::vector<SceneBatch> batches;
+        std::vector<glm::mat4> models;
+        // Batch of each mesh
+        std::vector<uint32_t> meshBatches;
+    };
+} // grass
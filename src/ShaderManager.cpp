@@ -0,0 +1,111 @@
+#include "ShaderManager.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "Tracer.h"
+
+
+namespace
+{
+    // Path of an #include "file" directive, empty if the line is not one
+    std::string parseInclude(const std::string& line)
+    {
+        const size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line.compare(start, 8, "#include") != 0) return "";
+
+        const size_t open = line.find('"', start + 8);
+        const size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+        if (close == std::string::npos) return "";
+        return line.substr(open + 1, close - open - 1);
+    }
+}
+
+
+wgpu::ShaderModule ShaderManager::getModule(const std::string& path, const std::string& label,
+                                            const std::vector<std::string>& includePaths)
+{
+    TRACE_ZONE("ShaderManager::getModule");
+    std::string source = preprocess(path, includePaths);
+    if (source.empty()) return nullptr;
+
+    if (const auto it = modules.find(source); it != modules.end())
+    {
+        hits++;
+        return it->second;
+    }
+
+    wgpu::ShaderModuleWGSLDescriptor wgslDesc;
+    wgslDesc.code = source.c_str();
+
+    wgpu::ShaderModuleDescriptor shaderModuleDesc{
+        .nextInChain = &wgslDesc,
+        .label = label.c_str()
+    };
+
+    wgpu::ShaderModule module = device.CreateShaderModule(&shaderModuleDesc);
+    if (module) modules.emplace(std::move(source), module);
+    return module;
+}
+
+
+std::string ShaderManager::preprocess(const std::string& path, const std::vector<std::string>& includePaths)
+{
+    std::unordered_set<std::string> included;
+    std::string source;
+    for (const std::string& includePath : includePaths)
+    {
+        if (!appendFile(includePath, included, source)) return "";
+    }
+    if (!appendFile(path, included, source)) return "";
+    return source;
+}
+
+
+bool ShaderManager::appendFile(const std::string& path, std::unordered_set<std::string>& included,
+                               std::string& source)
+{
+    const std::string normalPath = std::filesystem::path(path).lexically_normal().generic_string();
+    // Also stops include cycles
+    if (!included.insert(normalPath).second) return true;
+
+    const std::string* code = readFile(normalPath);
+    if (!code) return false;
+
+    const std::filesystem::path directory = std::filesystem::path(normalPath).parent_path();
+    std::istringstream lines(*code);
+    std::string line;
+    while (std::getline(lines, line))
+    {
+        const std::string includePath = parseInclude(line);
+        if (includePath.empty())
+        {
+            source.append(line).append("\n");
+            continue;
+        }
+        if (!appendFile((directory / includePath).generic_string(), included, source))
+        {
+            std::cerr << "Included from " << normalPath << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+
+const std::string* ShaderManager::readFile(const std::string& path)
+{
+    if (const auto it = files.find(path); it != files.end()) return &it->second;
+
+    std::ifstream shaderFile(path);
+    if (!shaderFile.is_open())
+    {
+        std::cerr << "Could not read shader file " << path << std::endl;
+        return nullptr;
+    }
+    std::stringstream shaderStream;
+    shaderStream << shaderFile.rdbuf();
+    return &files.emplace(path, shaderStream.str()).first->second;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <webgpu/webgpu_cpp.h>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Loads WGSL files, resolves their #include "file.wgsl" directives and shares one module per distinct source.
+// Includes are relative to the including file and inserted once per module, WGSL declarations being order
+// independent. Files are read once, edit a shader and restart to see the change.
+class ShaderManager
+{
+public:
+    explicit ShaderManager(const wgpu::Device& device) : device(device) {}
+
+    // Include paths select shader variants, they are inserted before the shader as if it included them
+    wgpu::ShaderModule getModule(const std::string& path, const std::string& label,
+                                 const std::vector<std::string>& includePaths = {});
+    // Shader source with every include resolved, empty if a file is missing
+    std::string preprocess(const std::string& path, const std::vector<std::string>& includePaths = {});
+
+    [[nodiscard]] size_t getHitCount() const { return hits; }
+    [[nodiscard]] size_t getModuleCount() const { return modules.size(); }
+
+private:
+    bool appendFile(const std::string& path, std::unordered_set<std::string>& included, std::string& source);
+    const std::string* readFile(const std::string& path);
+
+    wgpu::Device device;
+    size_t hits = 0;
+
+    // Keyed by preprocessed source, shaders sharing their code share their module
+    std::unordered_map<std::string, wgpu::ShaderModule> modules;
+    std::unordered_map<std::string, std::string> files;
+};
@@ -0,0 +1,53 @@
+#include "StartupScheduler.h"
+
+#include "GPUContext.h"
+#include "Tracer.h"
+
+
+namespace grass
+{
+    StartupScheduler::~StartupScheduler()
+    {
+        // Pending callbacks reference this scheduler
+        wait();
+    }
+
+
+    void StartupScheduler::createPipeline(const wgpu::RenderPipelineDescriptor& descriptor,
+                                          wgpu::RenderPipeline& target)
+    {
+        const wgpu::Future future = GPUContext::getInstance()->getObjectCache().getRenderPipelineAsync(
+            descriptor, [this, &target](const wgpu::RenderPipeline& pipeline)
+            {
+                target = pipeline;
+                failed |= pipeline == nullptr;
+            });
+        if (future.id != 0) futures.push_back(future);
+    }
+
+
+    void StartupScheduler::createPipeline(const wgpu::ComputePipelineDescriptor& descriptor,
+                                          wgpu::ComputePipeline& target)
+    {
+        const wgpu::Future future = GPUContext::getInstance()->getObjectCache().getComputePipelineAsync(
+            descriptor, [this, &target](const wgpu::ComputePipeline& pipeline)
+            {
+                target = pipeline;
+                failed |= pipeline == nullptr;
+            });
+        if (future.id != 0) futures.push_back(future);
+    }
+
+
+    bool StartupScheduler::wait()
+    {
+        TRACE_ZONE("StartupScheduler::wait");
+        GPUContext* ctx = GPUContext::getInstance();
+        for (const wgpu::Future& future : futures)
+        {
+            ctx->wait(future);
+        }
+        futures.clear();
+        return !failed;
+    }
+} // grass
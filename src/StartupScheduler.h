@@ -0,0 +1,35 @@
+#pragma once
+
+#include <webgpu/webgpu_cpp.h>
+#include <future>
+#include <vector>
+
+namespace grass
+{
+    // Startup work issued all at once : pipelines compile on Dawn's worker threads and asset files load on CPU
+    // threads, while the caller keeps creating resources. Startup then waits for the slowest pipeline instead of
+    // their sum. The device is not shared with the load threads, they only read and decode files.
+    class StartupScheduler
+    {
+    public:
+        StartupScheduler() = default;
+        StartupScheduler(const StartupScheduler&) = delete;
+        StartupScheduler& operator=(const StartupScheduler&) = delete;
+        ~StartupScheduler();
+
+        // The target is set once the pipeline is created, it must outlive wait()
+        void createPipeline(const wgpu::RenderPipelineDescriptor& descriptor, wgpu::RenderPipeline& target);
+        void createPipeline(const wgpu::ComputePipelineDescriptor& descriptor, wgpu::ComputePipeline& target);
+
+        // Runs the task on its own thread, its result is read with get()
+        template <typename F>
+        auto load(F&& task) { return std::async(std::launch::async, std::forward<F>(task)); }
+
+        // Waits for every pipeline issued so far, false if one could not be created
+        bool wait();
+
+    private:
+        std::vector<wgpu::Future> futures;
+        bool failed = false;
+    };
+} // grass
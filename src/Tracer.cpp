@@ -0,0 +1,93 @@
+#include "Tracer.h"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+
+namespace grass
+{
+    namespace
+    {
+        // Buffers are never freed so events of exited threads can still be dumped
+        std::mutex buffersMutex;
+        std::vector<std::unique_ptr<TraceBuffer>> buffers;
+
+        thread_local TraceBuffer* threadBuffer = nullptr;
+    }
+
+
+    std::vector<TraceEvent> TraceBuffer::snapshot() const
+    {
+        std::lock_guard lock(mutex);
+        const uint64_t begin = writeIndex > CAPACITY ? writeIndex - CAPACITY : 0;
+
+        std::vector<TraceEvent> copy;
+        copy.reserve(writeIndex - begin);
+        for (uint64_t i = begin; i < writeIndex; i++)
+        {
+            copy.push_back(events[i % CAPACITY]);
+        }
+        return copy;
+    }
+
+
+    int64_t Tracer::now()
+    {
+        static const auto origin = std::chrono::steady_clock::now();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+    }
+
+
+    TraceBuffer& Tracer::getThreadBuffer()
+    {
+        if (threadBuffer == nullptr)
+        {
+            std::lock_guard lock(buffersMutex);
+            buffers.push_back(std::make_unique<TraceBuffer>(static_cast<uint32_t>(buffers.size())));
+            threadBuffer = buffers.back().get();
+        }
+        return *threadBuffer;
+    }
+
+
+    bool Tracer::dump(const std::string& path)
+    {
+        if (!isEnabled())
+        {
+            std::cerr << "Tracing is compiled out, configure with GRASS_ENABLE_TRACING=ON" << std::endl;
+            return false;
+        }
+
+        std::ofstream file(path);
+        if (!file.is_open())
+        {
+            std::cerr << "Could not open " << path << " to write the trace" << std::endl;
+            return false;
+        }
+
+        std::lock_guard lock(buffersMutex);
+        bool first = true;
+        file << std::fixed << std::setprecision(3);
+        file << "{\"traceEvents\":[";
+        for (const auto& buffer : buffers)
+        {
+            for (const TraceEvent& event : buffer->snapshot())
+            {
+                // Complete events, timestamps in microseconds
+                file << (first ? "\n" : ",\n");
+                file << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->getThreadId()
+                    << ",\"ts\":" << static_cast<double>(event.startNs) * 1e-3
+                    << ",\"dur\":" << static_cast<double>(event.durationNs) * 1e-3 << "}";
+                first = false;
+            }
+        }
+        file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+        std::cout << "CPU trace written to " << path << std::endl;
+        return file.good();
+    }
+} // grass
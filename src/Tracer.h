@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Scoped CPU zones, dumped as Chrome trace events (chrome://tracing or ui.perfetto.dev).
+// Zones are compiled out unless GRASS_ENABLE_TRACING is defined, see the CMake option.
+#ifdef GRASS_ENABLE_TRACING
+#define GRASS_TRACE_CONCAT_IMPL(a, b) a##b
+#define GRASS_TRACE_CONCAT(a, b) GRASS_TRACE_CONCAT_IMPL(a, b)
+// The name must outlive the trace (a string literal), only its pointer is recorded
+#define TRACE_ZONE(name) grass::TraceZone GRASS_TRACE_CONCAT(traceZone, __LINE__){name}
+#else
+#define TRACE_ZONE(name)
+#endif
+
+namespace grass
+{
+    struct TraceEvent
+    {
+        const char* name = nullptr;
+        int64_t startNs = 0;
+        int64_t durationNs = 0;
+    };
+
+
+    // Written by its owning thread and read by dumps from any thread, the oldest events are overwritten once full.
+    // The lock is uncontended outside of dumps.
+    class TraceBuffer
+    {
+    public:
+        static constexpr uint64_t CAPACITY = 1 << 16;
+
+        explicit TraceBuffer(uint32_t threadId) : threadId(threadId) {}
+
+        void record(const TraceEvent& event)
+        {
+            std::lock_guard lock(mutex);
+            events[writeIndex % CAPACITY] = event;
+            writeIndex++;
+        }
+
+        // Oldest first
+        [[nodiscard]] std::vector<TraceEvent> snapshot() const;
+        [[nodiscard]] uint32_t getThreadId() const { return threadId; }
+
+    private:
+        mutable std::mutex mutex;
+        std::array<TraceEvent, CAPACITY> events{};
+        uint64_t writeIndex = 0;
+        uint32_t threadId;
+    };
+
+
+    class Tracer
+    {
+    public:
+        static constexpr bool isEnabled()
+        {
+#ifdef GRASS_ENABLE_TRACING
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        // Nanoseconds since the first call
+        static int64_t now();
+        static TraceBuffer& getThreadBuffer();
+        // Writes every thread's events in the Chrome trace event format
+        static bool dump(const std::string& path);
+    };
+
+
+    class TraceZone
+    {
+    public:
+        explicit TraceZone(const char* name) : name(name), startNs(Tracer::now()) {}
+        ~TraceZone() { Tracer::getThreadBuffer().record({name, startNs, Tracer::now() - startNs}); }
+
+        TraceZone(const TraceZone&) = delete;
+        TraceZone& operator=(const TraceZone&) = delete;
+
+    private:
+        const char* name;
+        int64_t startNs;
+    };
+} // grass
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace grass
+{
+    // Mesh vertex, also the layout of the vertex buffers and of the .gmesh files
+    struct VertexData
+    {
+        glm::vec3 position;
+        glm::vec3 normal;
+        glm::vec2 texCoord;
+    };
+} // grass
@@ -81,12 +81,14 @@ inline constexpr wgpu::BindGroupLayoutDescriptor phongMaterialBindGroupLayoutDes
 };
 
 
+// Model matrices of the scene batches indexed by instance, bound at a dynamic offset in the per-frame ring
 inline constexpr wgpu::BindGroupLayoutEntry modelBindGroupLayoutEntry[2] = {
     {
         .binding = 0,
-        .visibility = wgpu::ShaderStage::Vertex | wgpu::ShaderStage::Fragment,
+        .visibility = wgpu::ShaderStage::Vertex,
         .buffer = {
-            .type = wgpu::BufferBindingType::Uniform,
+            .type = wgpu::BufferBindingType::ReadOnlyStorage,
+            .hasDynamicOffset = true,
             .minBindingSize = sizeof(glm::mat4)
         }
     },
@@ -18,6 +18,11 @@ namespace grass
         // Single blades settings
         float bladeHeight = 0.9;
         float sizeNoiseAmplitude = 0.4;
+
+        // Terrain heightmap mapping
+        glm::vec2 terrainOrigin{}; // world xz of the heightmap corner
+        float terrainSize = 0.0; // world size covered by the heightmap
+        float terrainHeightScale = 1.0; // world height of a heightmap value of 1
     };
 
     struct GrassMovUniformData
@@ -28,6 +33,68 @@ namespace grass
         glm::vec3 padding;
     };
 
+    // Written every frame, shared by the wind field and movement passes
+    struct MovFrameUniformData
+    {
+        float time = 0.0;
+        float windFieldSize = 0.0; // world size covered by the wind field texture
+        glm::vec2 windFieldOrigin{}; // world xz of the wind field texture corner
+    };
+
+    struct CullUniformData
+    {
+        glm::vec4 frustumPlanes[6];
+        glm::vec3 cameraPosition;
+        float maxDistance = 35.0; // fog hides almost everything past that
+        uint32_t frustumCulling = 1; // 0 or 1
+        uint32_t lodStride = 0; // distance between two LOD lists in the visible blades buffer
+        uint32_t lodCount = 1;
+        float padding;
+        glm::vec4 lodDistances = {4.0, 12.0, 0.0, 0.0}; // distance at which LOD i switches to LOD i + 1
+    };
+
+    // One per chunk, bound with a dynamic offset by every blade compute pass
+    struct ChunkUniformData
+    {
+        glm::ivec2 cellOffset; // first blade cell of the chunk in the world grid, negative when streaming
+        glm::uvec2 cellCount; // blade cells covered by the chunk, smaller on the field border
+        uint32_t firstBlade = 0; // start of the chunk range in the blade buffers
+        uint32_t bladesPerSide = 0; // dispatch grid side, same for every chunk
+        glm::vec2 padding;
+    };
+
+    // Uniform grid centered on the camera, the colliders are binned into its cells every frame
+    struct ColliderGridUniformData
+    {
+        glm::vec2 origin{}; // world xz of the grid corner
+        float cellSize = 1.0;
+        float reach = 0.0; // distance past its radius at which a collider touches blades, the tallest blade height
+        uint32_t colliderCount = 0;
+        uint32_t cellsPerSide = 0;
+        uint32_t maxCellColliders = 0;
+        float padding;
+    };
+
+    // World space collider pushing the blades, a sphere when a and b are equal, a capsule otherwise
+    struct ColliderData
+    {
+        glm::vec3 a;
+        float radius;
+        glm::vec3 b;
+        float padding;
+    };
+
+    // Written every frame, shared by the trample and movement passes. See trample.wgsl
+    struct TrampleUniformData
+    {
+        glm::ivec2 originTexel{}; // world texel of the trample window corner
+        glm::ivec2 previousOriginTexel{};
+        float texelSize = 1.0;
+        uint32_t resolution = 0;
+        float decay = 1.0; // fraction of the trails left since the last frame
+        float bladeHeight = 1.0; // displacements are stamped for a blade that tall
+    };
+
     // Rendering uniforms
     struct LightUniformData
     {
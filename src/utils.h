@@ -2,6 +2,7 @@
 
 #include <webgpu/webgpu_cpp.h>
 #include <string>
+#include <vector>
 #include <glm/glm.hpp>
 #include <tiny_obj_loader.h>
 #include <stb_image.h>
@@ -9,71 +10,32 @@
 #include <fstream>
 #include <sstream>
 
-#define COMMON_PATH "../shaders/common.wgsl"
+#include "Tracer.h"
+#include "VertexData.h"
+
+#define BLADE_LAYOUT_PATH "../shaders/blade_layout.wgsl"
+#define PACKED_BLADE_LAYOUT_PATH "../shaders/blade_layout_packed.wgsl"
+#define SHADOW_DEPTH_PATH "../shaders/shadow_depth.wgsl"
+#define MULTISAMPLED_SHADOW_DEPTH_PATH "../shaders/shadow_depth_multisampled.wgsl"
 
 
 namespace grass
 {
-    struct VertexData
-    {
-        glm::vec3 position;
-        glm::vec3 normal;
-        glm::vec2 texCoord;
-    };
-
-
-    inline void parseShaderFile(const std::string& filePath, std::string& sourceCode)
+    inline std::string getBladeLayoutPath(bool packedBlades)
     {
-        std::ifstream shaderFile;
-        // ensure ifstream objects can throw exceptions:
-        shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        try
-        {
-            // open files
-            shaderFile.open(filePath);
-            std::stringstream shaderStream;
-            // read file's buffer contents into streams
-            shaderStream << shaderFile.rdbuf();
-            // close file handlers
-            shaderFile.close();
-            // convert stream into string
-            sourceCode = shaderStream.str();
-        }
-        catch (std::ifstream::failure& e)
-        {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ : " << filePath << std::endl;
-        }
+        return packedBlades ? PACKED_BLADE_LAYOUT_PATH : BLADE_LAYOUT_PATH;
     }
 
 
-    inline wgpu::ShaderModule getShaderModule(const wgpu::Device& device, const std::string& shaderPath,
-                                              const std::string& moduleLabel,
-                                              bool includeCommon = true)
+    inline std::string getShadowDepthPath(bool multiSample)
     {
-        std::string shaderCode;
-        parseShaderFile(shaderPath, shaderCode);
-
-        if (includeCommon)
-        {
-            std::string structsCode;
-            parseShaderFile(COMMON_PATH, structsCode);
-            shaderCode.insert(0, structsCode);
-        }
-
-        wgpu::ShaderModuleWGSLDescriptor wgslDesc;
-        wgslDesc.code = shaderCode.c_str();
-
-        wgpu::ShaderModuleDescriptor shaderModuleDesc{
-            .nextInChain = &wgslDesc,
-            .label = moduleLabel.c_str()
-        };
-
-        return device.CreateShaderModule(&shaderModuleDesc);
+        return multiSample ? MULTISAMPLED_SHADOW_DEPTH_PATH : SHADOW_DEPTH_PATH;
     }
 
 
     inline bool loadVertexData(const std::string& filePath, std::vector<VertexData>& verticesData)
     {
+        TRACE_ZONE("loadVertexData");
         tinyobj::ObjReaderConfig readerConfig;
         readerConfig.mtl_search_path = "./";
 
@@ -97,6 +59,7 @@ namespace grass
         auto& shapes = reader.GetShapes();
 
         const auto& shape = shapes[0]; // look at the first shape only
+        verticesData.reserve(verticesData.size() + shape.mesh.indices.size());
 
         size_t i = 0;
         for (size_t f = 0; f < shape.mesh.num_face_vertices.size(); f++)
@@ -142,16 +105,54 @@ namespace grass
     }
 
 
-    inline wgpu::Texture loadTexture(const std::string& path)
+    // Empty on failure, no device access
+    inline std::vector<VertexData> loadVertexData(const std::string& filePath)
     {
+        std::vector<VertexData> verticesData;
+        if (!loadVertexData(filePath, verticesData))
+        {
+            std::cerr << "Could not load geometry " << filePath << std::endl;
+            verticesData.clear();
+        }
+        return verticesData;
+    }
+
+
+    // RGBA8 pixels decoded on the CPU, see createTexture
+    struct ImageData
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<unsigned char> pixels;
+    };
+
+
+    // No device access, safe to run on a load thread
+    inline ImageData loadImageData(const std::string& path)
+    {
+        TRACE_ZONE("loadImageData");
         int width, height, channels;
         unsigned char* pixelData = stbi_load(path.c_str(), &width, &height, &channels, 4);
-        if (nullptr == pixelData) return nullptr;
+        if (nullptr == pixelData) return {};
+
+        ImageData image = {
+            .width = static_cast<uint32_t>(width),
+            .height = static_cast<uint32_t>(height),
+            .pixels = {pixelData, pixelData + 4 * width * height},
+        };
+        stbi_image_free(pixelData);
+        return image;
+    }
+
+
+    inline wgpu::Texture createTexture(const ImageData& image)
+    {
+        if (image.pixels.empty()) return nullptr;
 
         const wgpu::Device device = GPUContext::getInstance()->getDevice();
         const wgpu::Queue queue = GPUContext::getInstance()->getQueue();
 
-        wgpu::Extent3D textureSize = {static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1};
+        wgpu::Extent3D textureSize = {image.width, image.height, 1};
 
         wgpu::TextureDescriptor textureDesc;
         textureDesc.dimension = wgpu::TextureDimension::e2D;
@@ -174,10 +175,15 @@ namespace grass
             .rowsPerImage = textureSize.height
         };
 
-        queue.WriteTexture(&dest, pixelData, 4 * width * height, &source, &textureSize);
-
-        stbi_image_free(pixelData);
+        queue.WriteTexture(&dest, image.pixels.data(), image.pixels.size(), &source, &textureSize);
 
         return texture;
     }
+
+
+    inline wgpu::Texture loadTexture(const std::string& path)
+    {
+        TRACE_ZONE("loadTexture");
+        return createTexture(loadImageData(path));
+    }
 }